@@ -126,6 +126,18 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// sparse_poly_gen
+Rcpp::List sparse_poly_gen(int kind_gen, int dim_gen);
+RcppExport SEXP _volesti_sparse_poly_gen(SEXP kind_genSEXP, SEXP dim_genSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type kind_gen(kind_genSEXP);
+    Rcpp::traits::input_parameter< int >::type dim_gen(dim_genSEXP);
+    rcpp_result_gen = Rcpp::wrap(sparse_poly_gen(kind_gen, dim_gen));
+    return rcpp_result_gen;
+END_RCPP
+}
 // psrf_multivariate
 double psrf_multivariate(Rcpp::NumericMatrix samples);
 RcppExport SEXP _volesti_psrf_multivariate(SEXP samplesSEXP) {
@@ -164,28 +176,30 @@ BEGIN_RCPP
 END_RCPP
 }
 // rotating
-Rcpp::NumericMatrix rotating(Rcpp::Reference P, Rcpp::Nullable<Rcpp::NumericMatrix> T, Rcpp::Nullable<int> seed);
-RcppExport SEXP _volesti_rotating(SEXP PSEXP, SEXP TSEXP, SEXP seedSEXP) {
+Rcpp::NumericMatrix rotating(Rcpp::Reference P, Rcpp::Nullable<Rcpp::NumericMatrix> T, Rcpp::Nullable<int> seed, Rcpp::Nullable<std::string> method);
+RcppExport SEXP _volesti_rotating(SEXP PSEXP, SEXP TSEXP, SEXP seedSEXP, SEXP methodSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::Reference >::type P(PSEXP);
     Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericMatrix> >::type T(TSEXP);
     Rcpp::traits::input_parameter< Rcpp::Nullable<int> >::type seed(seedSEXP);
-    rcpp_result_gen = Rcpp::wrap(rotating(P, T, seed));
+    Rcpp::traits::input_parameter< Rcpp::Nullable<std::string> >::type method(methodSEXP);
+    rcpp_result_gen = Rcpp::wrap(rotating(P, T, seed, method));
     return rcpp_result_gen;
 END_RCPP
 }
 // rounding
-Rcpp::List rounding(Rcpp::Reference P, Rcpp::Nullable<std::string> method, Rcpp::Nullable<double> seed);
-RcppExport SEXP _volesti_rounding(SEXP PSEXP, SEXP methodSEXP, SEXP seedSEXP) {
+Rcpp::List rounding(Rcpp::Reference P, Rcpp::Nullable<std::string> method, Rcpp::Nullable<double> seed, Rcpp::Nullable<unsigned int> num_threads);
+RcppExport SEXP _volesti_rounding(SEXP PSEXP, SEXP methodSEXP, SEXP seedSEXP, SEXP num_threadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::Reference >::type P(PSEXP);
     Rcpp::traits::input_parameter< Rcpp::Nullable<std::string> >::type method(methodSEXP);
     Rcpp::traits::input_parameter< Rcpp::Nullable<double> >::type seed(seedSEXP);
-    rcpp_result_gen = Rcpp::wrap(rounding(P, method, seed));
+    Rcpp::traits::input_parameter< Rcpp::Nullable<unsigned int> >::type num_threads(num_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rounding(P, method, seed, num_threads));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -220,15 +234,43 @@ BEGIN_RCPP
 END_RCPP
 }
 // volume
-Rcpp::List volume(Rcpp::Reference P, Rcpp::Nullable<Rcpp::List> settings, Rcpp::Nullable<std::string> rounding);
-RcppExport SEXP _volesti_volume(SEXP PSEXP, SEXP settingsSEXP, SEXP roundingSEXP) {
+Rcpp::List volume(Rcpp::Reference P, Rcpp::Nullable<Rcpp::List> settings, Rcpp::Nullable<std::string> rounding, Rcpp::Nullable<std::string> resume);
+RcppExport SEXP _volesti_volume(SEXP PSEXP, SEXP settingsSEXP, SEXP roundingSEXP, SEXP resumeSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::Reference >::type P(PSEXP);
     Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::List> >::type settings(settingsSEXP);
     Rcpp::traits::input_parameter< Rcpp::Nullable<std::string> >::type rounding(roundingSEXP);
-    rcpp_result_gen = Rcpp::wrap(volume(P, settings, rounding));
+    Rcpp::traits::input_parameter< Rcpp::Nullable<std::string> >::type resume(resumeSEXP);
+    rcpp_result_gen = Rcpp::wrap(volume(P, settings, rounding, resume));
+    return rcpp_result_gen;
+END_RCPP
+}
+// volume_batch
+Rcpp::DataFrame volume_batch(Rcpp::List polytopes, Rcpp::Nullable<Rcpp::List> settings, Rcpp::Nullable<std::string> rounding, unsigned int num_threads);
+RcppExport SEXP _volesti_volume_batch(SEXP polytopesSEXP, SEXP settingsSEXP, SEXP roundingSEXP, SEXP num_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type polytopes(polytopesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::List> >::type settings(settingsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<std::string> >::type rounding(roundingSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type num_threads(num_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(volume_batch(polytopes, settings, rounding, num_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// vpoly_membership
+Rcpp::List vpoly_membership(Rcpp::Reference P, Rcpp::NumericMatrix points, unsigned int cache_size);
+RcppExport SEXP _volesti_vpoly_membership(SEXP PSEXP, SEXP pointsSEXP, SEXP cache_sizeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::Reference >::type P(PSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type points(pointsSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type cache_size(cache_sizeSEXP);
+    rcpp_result_gen = Rcpp::wrap(vpoly_membership(P, points, cache_size));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -269,14 +311,17 @@ static const R_CallMethodDef CallEntries[] = {
     {"_volesti_inner_ball", (DL_FUNC) &_volesti_inner_ball, 2},
     {"_volesti_load_sdpa_format_file", (DL_FUNC) &_volesti_load_sdpa_format_file, 1},
     {"_volesti_poly_gen", (DL_FUNC) &_volesti_poly_gen, 6},
+    {"_volesti_sparse_poly_gen", (DL_FUNC) &_volesti_sparse_poly_gen, 2},
     {"_volesti_psrf_multivariate", (DL_FUNC) &_volesti_psrf_multivariate, 1},
     {"_volesti_psrf_univariate", (DL_FUNC) &_volesti_psrf_univariate, 2},
     {"_volesti_raftery", (DL_FUNC) &_volesti_raftery, 4},
-    {"_volesti_rotating", (DL_FUNC) &_volesti_rotating, 3},
-    {"_volesti_rounding", (DL_FUNC) &_volesti_rounding, 3},
+    {"_volesti_rotating", (DL_FUNC) &_volesti_rotating, 4},
+    {"_volesti_rounding", (DL_FUNC) &_volesti_rounding, 4},
     {"_volesti_sample_points", (DL_FUNC) &_volesti_sample_points, 5},
     {"_volesti_uniform_sample_correlation_matrices", (DL_FUNC) &_volesti_uniform_sample_correlation_matrices, 5},
-    {"_volesti_volume", (DL_FUNC) &_volesti_volume, 3},
+    {"_volesti_volume", (DL_FUNC) &_volesti_volume, 4},
+    {"_volesti_volume_batch", (DL_FUNC) &_volesti_volume_batch, 4},
+    {"_volesti_vpoly_membership", (DL_FUNC) &_volesti_vpoly_membership, 3},
     {"_volesti_write_sdpa_format_file", (DL_FUNC) &_volesti_write_sdpa_format_file, 3},
     {"_volesti_zono_approx", (DL_FUNC) &_volesti_zono_approx, 4},
     {NULL, NULL, 0}
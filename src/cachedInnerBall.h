@@ -0,0 +1,48 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2024 Vissarion Fisikopoulos
+// Copyright (c) 2018-2024 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+
+#ifndef CACHEDINNERBALL_H
+#define CACHEDINNERBALL_H
+
+// If the R object P keeps an inscribed ball in slot 'inner_ball' pass it to the polytope,
+// so that ComputeInnerBall() returns it instead of computing a new one. A ball with a
+// non positive radius, with a center out of the polytope or with a radius larger than
+// the distance of the center from the boundary along a coordinate axis, e.g. a slot
+// that was kept after the polytope changed, is ignored.
+template <class Polytope>
+void set_cached_inner_ball(Rcpp::Reference P, Polytope &Poly) {
+
+    typedef typename Polytope::PointType Point;
+    typedef typename Polytope::VT        VT;
+    typedef typename Point::FT           NT;
+
+    if (!P.hasSlot("inner_ball")) return;
+
+    VT ball = Rcpp::as<VT>(P.slot("inner_ball"));
+    unsigned int n = Poly.dimension();
+    if (ball.size() != n + 1) return;
+
+    Point center(VT(ball.head(n)));
+    NT radius = ball(n);
+    if (!(radius > 0.0) || Poly.is_in(center) == 0) return;
+
+    // d line shots from the center, a ball of the polytope contains the 2d points
+    // center +- radius e_i
+    for (unsigned int i = 0; i < n; ++i) {
+        Point e(n);
+        e.set_coord(i, NT(1));
+        std::pair<NT, NT> lambdas = Poly.line_intersect(center, e);
+        if (std::min(std::abs(lambdas.first), std::abs(lambdas.second)) < radius * (NT(1) - NT(1e-10))) {
+            return;
+        }
+    }
+
+    Poly.set_InnerBall(std::pair<Point, NT>(center, radius));
+}
+
+#endif
@@ -41,6 +41,7 @@ template <int k, typename Ti> struct PackedChol {
   SparseMatrix<Tx, Ti> At;
   UniqueAlignedPtr<Tx2> w;
   Tx accuracyThreshold = 1e-6;
+  int numThreads = 1; // threads of the supernodal factorization
   std::vector<size_t>
       exactIdx; // k size array. Indices we perform high precision calculation
   std::vector<size_t>
@@ -93,6 +94,7 @@ template <int k, typename Ti> struct PackedChol {
         !decomposed) // the first time we call, always run the double chol.
     {
       multiply(H, A, w.get(), At);
+      L.num_threads = numThreads;
       chol(L, H);
       decomposed = true;
 
@@ -117,6 +119,7 @@ template <int k, typename Ti> struct PackedChol {
         ++numExact[i];
         get_slice(w_exact, w.get(), n, i);
         multiply(H_exact, A, w_exact, At);
+        L_exact.num_threads = numThreads;
         chol(L_exact, H_exact);
 
         // copy result to Le[i]
@@ -8,10 +8,14 @@
 //(https://github.com/ConstrainedSampler/PolytopeSamplerMatlab/blob/master/code/solver/PackedCSparse/PackedChol.h) by Ioannis Iakovidis
 
 #pragma once
+#include <algorithm>
 #include <vector>
 #include <queue>
 #include "SparseMatrix.h"
 #include "transpose.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 // Problem:
 // Compute chol(A)
@@ -26,6 +30,13 @@
 // chol_left_looking:
 //		Compute L col by col
 //		This is faster when it is memory bound.
+//
+// chol_supernodal:
+//		Compute L supernode by supernode, i.e. by blocks of consecutive
+//		columns with the same pattern below the block. A block is factorized
+//		densely after the updates of its descendants, which are dense products
+//		too. The supernodes of the same height in the elimination tree do not
+//		depend on each other and they are factorized in parallel.
 
 
 namespace PackedCSparse {
@@ -37,6 +48,22 @@ namespace PackedCSparse {
 		UniquePtr<Ti> c;				// c[i] = index the last nonzero on column i in the current L
 		UniqueAlignedPtr<Tx> w;			// the row of L we are computing
 
+		int num_threads = 1;			// threads of chol_supernodal
+		Ti ns = 0;						// number of supernodes
+		UniquePtr<Ti> super;			// supernode s is the columns super[s], ..., super[s+1]-1
+		UniquePtr<Ti> snode;			// snode[j] = the supernode of column j
+		std::vector<std::vector<Ti>> levels; // the supernodes by their height in the elimination tree
+		size_t block_size = 0;			// the largest rows x columns of a supernode
+
+		// workspace of every thread: the dense block, the product of an update,
+		// the relative row indices and the marks of the descendants
+		struct Workspace
+		{
+			UniqueAlignedPtr<Tx> block, update;
+			UniquePtr<Ti> map, mark;
+		};
+		std::vector<Workspace> work;
+
 		// The cost of this is roughly 3 times larger than chol
 		// One can optimize it by using other data structure
 		void initialize(const SparseMatrix<Tx, Ti>& A)
@@ -124,6 +151,65 @@ namespace PackedCSparse {
 			Tx Tv0 = Tx(0);
 			for (Ti k = 0; k < n; k++)
 				w[k] = Tv0;
+
+			initialize_supernodes();
+		}
+
+		// The rows of each column are sorted, so column j-1 belongs to the
+		// supernode of column j when j is its parent and the pattern of column
+		// j is that of column j-1 without j-1.
+		void initialize_supernodes()
+		{
+			Ti n = this->n, * Lp = this->p.get(), * Li = this->i.get();
+
+			this->super.reset(new Ti[n + 1]);
+			this->snode.reset(new Ti[n]);
+			ns = 0;
+			for (Ti j = 0; j < n; j++)
+			{
+				bool merge = j > 0 && Lp[j] - Lp[j - 1] == Lp[j + 1] - Lp[j] + 1 && Li[Lp[j - 1] + 1] == j;
+				if (!merge)
+					super[ns++] = j;
+				snode[j] = ns - 1;
+			}
+			super[ns] = n;
+
+			// the height of a supernode is one more than the largest one of its children
+			std::vector<Ti> height(ns, 0);
+			Ti max_height = 0;
+			block_size = 0;
+			for (Ti s = 0; s < ns; s++)
+			{
+				Ti last = super[s + 1] - 1;
+				Ti rows = Lp[super[s] + 1] - Lp[super[s]];
+				block_size = std::max(block_size, size_t(rows) * size_t(super[s + 1] - super[s]));
+				max_height = std::max(max_height, height[s]);
+				if (Lp[last + 1] - Lp[last] > 1)
+				{
+					Ti parent = snode[Li[Lp[last] + 1]];
+					height[parent] = std::max(height[parent], height[s] + 1);
+				}
+			}
+			levels.assign(ns > 0 ? max_height + 1 : 0, std::vector<Ti>());
+			for (Ti s = 0; s < ns; s++)
+				levels[height[s]].push_back(s);
+			work.clear();
+		}
+
+		void initialize_workspace(int threads)
+		{
+			if (int(work.size()) >= threads) return;
+			work.resize(threads);
+			for (Workspace& ws : work)
+			{
+				if (ws.block) continue;
+				ws.block.reset(pcs_aligned_new<Tx>(std::max(block_size, size_t(1))));
+				ws.update.reset(pcs_aligned_new<Tx>(std::max(block_size, size_t(1))));
+				ws.map.reset(new Ti[std::max(this->n, Ti(1))]);
+				ws.mark.reset(new Ti[std::max(ns, Ti(1))]);
+				for (Ti s = 0; s < ns; s++)
+					ws.mark[s] = -1;
+			}
 		}
 	};
 
@@ -134,7 +220,8 @@ namespace PackedCSparse {
 			o.initialize(A);
 
 		//chol_up_looking(o, A);
-		chol_left_looking(o, A);
+		//chol_left_looking(o, A);
+		chol_supernodal(o, A);
 	}
 
 	template <typename Tx, typename Ti>
@@ -237,6 +324,157 @@ namespace PackedCSparse {
 		}
 	}
 
+	// Factorize the supernode s whose descendants are factorized. The columns
+	// f, ..., l-1 of the supernode and their rows r_0 = f, ..., r_{m-1} are the
+	// lower trapezoid of a dense m x (l-f) block in column major order.
+	template <typename Tx, typename Ti>
+	void chol_supernode(CholOutput<Tx, Ti>& o, const SparseMatrix<Tx, Ti>& A, Ti s,
+		typename CholOutput<Tx, Ti>::Workspace& ws)
+	{
+		Ti* Ap = A.p.get(), * Ai = A.i.get(); Tx* Ax = A.x.get();
+		Ti* Lp = o.p.get(); Ti* Li = o.i.get();
+		Ti* Ltp = o.Lt.p.get(); Ti* Lti = o.Lt.i.get();
+		Tx* Lx = o.x.get(); Ti* c = o.c.get();
+		Ti* diag = o.diag.get(); Ti* snode = o.snode.get();
+		Tx* W = ws.block.get(); Tx* U = ws.update.get();
+		Ti* map = ws.map.get(); Ti* mark = ws.mark.get();
+		Tx T0 = Tx(0), T1 = Tx(1);
+
+		Ti f = o.super[s], l = o.super[s + 1], cols = l - f;
+		Ti m = Lp[f + 1] - Lp[f], * rows = Li + Lp[f];
+
+		for (Ti k = 0; k < m; ++k)
+			map[rows[k]] = k;
+		for (size_t k = 0; k < size_t(m) * size_t(cols); ++k)
+			W[k] = T0;
+
+		// W = A_{rows, f:l-1}
+		for (Ti j = f; j < l; ++j)
+		{
+			Tx* Wj = W + size_t(j - f) * m;
+			for (Ti is = diag[j]; is < Ap[j + 1]; ++is)
+				Wj[map[Ai[is]]] = Ax[is];
+		}
+
+		// W -= L_{rows, K} L_{f:l-1, K}^T for every descendant supernode K with
+		// a nonzero in the rows f, ..., l-1. All the columns of K have the rows
+		// B = {b_0 < b_1 < ...} from c[p] on and b_0, ..., b_{t-1} are below l.
+		for (Ti j = f; j < l; ++j)
+		{
+			for (Ti ps = Ltp[j]; ps < Ltp[j + 1] && Lti[ps] < f; ++ps)
+			{
+				Ti K = snode[Lti[ps]];
+				if (mark[K] == s) continue;
+				mark[K] = s;
+
+				Ti fk = o.super[K], lk = o.super[K + 1];
+				Ti q = Lp[fk + 1] - c[fk], * B = Li + c[fk];
+				Ti t = 0;
+				while (t < q && B[t] < l) ++t;
+
+				// a single column is scattered to W directly
+				if (lk - fk == 1)
+				{
+					Tx* x = Lx + c[fk];
+					for (Ti b = 0; b < t; ++b)
+					{
+						Tx Lbp = x[b], * Wb = W + size_t(B[b] - f) * m;
+						for (Ti a = b; a < q; ++a)
+							fnmadd(Wb[map[B[a]]], x[a], Lbp);
+					}
+					c[fk] += t;
+					continue;
+				}
+
+				// U = L_{B, K} L_{b_0:b_{t-1}, K}^T, the lower part of its first t columns
+				for (Ti b = 0; b < t; ++b)
+					for (Ti a = b; a < q; ++a)
+						U[size_t(b) * q + a] = T0;
+				for (Ti p = fk; p < lk; ++p)
+				{
+					Tx* x = Lx + c[p];
+					for (Ti b = 0; b < t; ++b)
+					{
+						Tx Lbp = x[b], * Ub = U + size_t(b) * q;
+						for (Ti a = b; a < q; ++a)
+							fmadd(Ub[a], x[a], Lbp);
+					}
+					c[p] += t;
+				}
+
+				for (Ti b = 0; b < t; ++b)
+				{
+					Tx* Wb = W + size_t(B[b] - f) * m, * Ub = U + size_t(b) * q;
+					for (Ti a = b; a < q; ++a)
+						Wb[map[B[a]]] -= Ub[a];
+				}
+			}
+		}
+
+		// dense Cholesky of the block
+		for (Ti j = 0; j < cols; ++j)
+		{
+			Tx* Wj = W + size_t(j) * m;
+			Tx Ljj = clipped_sqrt(Wj[j], 1e128);
+			Wj[j] = Ljj;
+			Tx inv_Ljj = T1 / Ljj;
+			for (Ti k = j + 1; k < m; ++k)
+				Wj[k] *= inv_Ljj;
+
+			for (Ti i = j + 1; i < cols; ++i)
+			{
+				Tx Lij = Wj[i], * Wi = W + size_t(i) * m;
+				for (Ti k = i; k < m; ++k)
+					fnmadd(Wi[k], Wj[k], Lij);
+			}
+		}
+
+		for (Ti j = 0; j < cols; ++j)
+		{
+			Tx* Wj = W + size_t(j) * m, * x = Lx + Lp[f + j];
+			for (Ti k = j; k < m; ++k)
+				x[k - j] = Wj[k];
+			c[f + j] = Lp[f + j] + (cols - j); // the first row below l
+		}
+	}
+
+	template <typename Tx, typename Ti>
+	void chol_supernodal(CholOutput<Tx, Ti>& o, const SparseMatrix<Tx, Ti>& A)
+	{
+		int threads = std::max(o.num_threads, 1);
+#ifndef _OPENMP
+		threads = 1;
+#endif
+		o.initialize_workspace(threads);
+		for (Ti s = 0; s < o.ns; s++)
+			for (int t = 0; t < int(o.work.size()); t++)
+				o.work[t].mark[s] = -1;
+
+		// the supernodes are ordered after their descendants
+		if (threads == 1)
+		{
+			for (Ti s = 0; s < o.ns; s++)
+				chol_supernode(o, A, s, o.work[0]);
+			return;
+		}
+
+		for (std::vector<Ti> const& level : o.levels)
+		{
+			Ti size = Ti(level.size());
+			int level_threads = int(std::min(Ti(threads), size));
+			#pragma omp parallel for num_threads(level_threads) schedule(dynamic) if(level_threads > 1)
+			for (Ti k = 0; k < size; ++k)
+			{
+#ifdef _OPENMP
+				int t = omp_get_thread_num();
+#else
+				int t = 0;
+#endif
+				chol_supernode(o, A, level[k], o.work[t]);
+			}
+		}
+	}
+
 	template <typename Tx, typename Ti>
 	CholOutput<Tx, Ti> chol(const SparseMatrix<Tx, Ti>& A)
 	{
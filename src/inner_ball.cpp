@@ -11,13 +11,17 @@
 #include <boost/random/uniform_real_distribution.hpp>
 #include "volume/volume_sequence_of_balls.hpp"
 #include "preprocess/max_inscribed_ball.hpp"
+#include "cachedInnerBall.h"
+#include "sparseHpolytope.h"
 
 //' Compute an inscribed ball of a convex polytope
 //'
 //' For a H-polytope described by a \eqn{m\times d} matrix \eqn{A} and a \eqn{m}-dimensional vector \eqn{b}, s.t.: \eqn{P=\{x\ |\  Ax\leq b\} }, this function computes the largest inscribed ball (Chebychev ball) by solving the corresponding linear program.
+//' For a sparse H-polytope the finite bounds \eqn{lb\leq x\leq ub} are added to the inequalities and the linear program is solved by an interior point method that factorizes the sparse normal equations, thus the matrix is never stored as a dense one.
 //' For both zonotopes and V-polytopes the function computes the minimum \eqn{r} s.t.: \eqn{ r e_i \in P} for all \eqn{i=1, \dots ,d}. Then the ball centered at the origin with radius \eqn{r/ \sqrt{d}} is an inscribed ball.
+//' P is not modified; the ball of a zonotope or a V-polytope can be stored in its slot \code{inner_ball}, i.e. \code{P@inner_ball = inner_ball(P)}, thus the functions of the package that are called with P later do not compute it again.
 //'
-//' @param P A convex polytope. It is an object from class (a) Hpolytope or (b) Vpolytope or (c) Zonotope or (d) VpolytopeIntersection.
+//' @param P A convex polytope. It is an object from class (a) Hpolytope or (b) Vpolytope or (c) Zonotope or (d) VpolytopeIntersection or (e) HpolytopeSparse without equality constraints.
 //' @param lpsolve Optional. A boolean variable to compute the Chebychev ball of an H-polytope using the lpsolve library.
 //'
 //' @return A \eqn{(d+1)}-dimensional vector that describes the inscribed ball. The first \eqn{d} coordinates corresponds to the center of the ball and the last one to the radius.
@@ -45,6 +49,8 @@ Rcpp::NumericVector inner_ball(Rcpp::Reference P,
     typedef IntersectionOfVpoly<Vpolytope, RNGType> InterVP;
     typedef Eigen::Matrix<NT,Eigen::Dynamic,1> VT;
     typedef Eigen::Matrix<NT,Eigen::Dynamic,Eigen::Dynamic> MT;
+    typedef Eigen::SparseMatrix<NT> SpMat;
+    typedef HPolytope<Point, SpMat> HpolytopeSparse;
 
     std::pair <Point, NT> InnerBall;
     bool lp_solve = (lpsolve.isNotNull()) ? Rcpp::as<bool>(lpsolve) : false;
@@ -65,6 +71,9 @@ Rcpp::NumericVector inner_ball(Rcpp::Reference P,
     } else if (type_str.compare(std::string("VpolytopeIntersection")) == 0) {
         n = Rcpp::as<MT>(P.slot("V1")).cols();
         type = 4;
+    } else if (type_str.compare(std::string("HpolytopeSparse")) == 0) {
+        n = Rcpp::as<SpMat>(P.slot("Aineq")).cols();
+        type = 5;
     } else {
         throw Rcpp::exception("Unknown polytope representation!");
     }
@@ -84,6 +93,7 @@ Rcpp::NumericVector inner_ball(Rcpp::Reference P,
         case 2: {
             // Vpolytope
             Vpolytope VP(n, Rcpp::as<MT>(P.slot("V")), VT::Ones(Rcpp::as<MT>(P.slot("V")).rows()));
+            set_cached_inner_ball(P, VP);
             InnerBall = VP.ComputeInnerBall();
             if (InnerBall.second < 0.0) throw Rcpp::exception("Unable to compute a feasible point.");
             break;
@@ -91,6 +101,7 @@ Rcpp::NumericVector inner_ball(Rcpp::Reference P,
         case 3: {
             // Zonotope
             zonotope ZP(n, Rcpp::as<MT>(P.slot("G")), VT::Ones(Rcpp::as<MT>(P.slot("G")).rows()));
+            set_cached_inner_ball(P, ZP);
             InnerBall = ZP.ComputeInnerBall();
             if (InnerBall.second < 0.0) throw Rcpp::exception("Unable to compute a feasible point.");
             break;
@@ -105,6 +116,17 @@ Rcpp::NumericVector inner_ball(Rcpp::Reference P,
             if (InnerBall.second < 0.0) throw Rcpp::exception("Unable to compute a feasible point.");
             break;
         }
+        case 5: {
+            // Sparse Hpolytope, the finite bounds lb <= x <= ub are appended to the inequalities
+            HpolytopeSparse HP = sparse_hpolytope<HpolytopeSparse>(P, "it has no inscribed ball.");
+            if (lp_solve) {
+                InnerBall = ComputeChebychevBall<NT, Point>(HP.get_mat(), HP.get_vec());
+            } else {
+                InnerBall = HP.ComputeInnerBall();
+            }
+            if (InnerBall.second < 0.0) throw Rcpp::exception("Unable to compute a feasible point.");
+            break;
+        }
     }
 
     Rcpp::NumericVector vec(n + 1);
@@ -112,3 +112,39 @@ Rcpp::NumericMatrix poly_gen (int kind_gen, bool Vpoly_gen, bool Zono_gen, int d
     throw Rcpp::exception("Wrong inputs!");
 
 }
+
+//' An internal Rccp function as a generator of H-polytopes defined by sparse matrices
+//'
+//' @param kind_gen An integer to declare the type of the polytope, i.e. 4 for the product of simplices and 7 for the Birkhoff polytope.
+//' @param dim_gen An integer to declare the dimension of the requested polytope.
+//'
+//' @keywords internal
+//'
+//' @return A list with the sparse matrix \code{Aineq} and the vector \code{bineq} of the inequalities of the requested polytope
+// [[Rcpp::export]]
+Rcpp::List sparse_poly_gen (int kind_gen, int dim_gen) {
+
+    typedef double NT;
+    typedef Cartesian <NT> Kernel;
+    typedef typename Kernel::Point Point;
+    typedef Eigen::SparseMatrix<NT> SpMat;
+    typedef HPolytope <Point, SpMat> Hpolytope;
+
+    Hpolytope P;
+    switch (kind_gen) {
+
+        case 4:
+            P = generate_prod_simplex<Hpolytope>(dim_gen);
+            break;
+
+        case 7:
+            P = generate_birkhoff<Hpolytope>(dim_gen);
+            break;
+
+        default:
+            throw Rcpp::exception("Wrong inputs!");
+    }
+
+    return Rcpp::List::create(Rcpp::Named("Aineq") = Rcpp::wrap(P.get_mat()),
+                              Rcpp::Named("bineq") = Rcpp::wrap(P.get_vec()));
+}
@@ -25,6 +25,7 @@
 //' @param P A convex polytope (H-, V-polytope or a zonotope).
 //' @param T Optional. A rotation matrix.
 //' @param seed Optional. A fixed seed for the random linear map generator.
+//' @param method Optional. A string to declare the random rotation: a) \code{'QR'} for a dense random orthogonal matrix or b) \code{'hadamard'} for a product of random sign diagonal matrices and Walsh-Hadamard transforms, applied in \eqn{O(md\log d)}. The default value is \code{'QR'}.
 //'
 //' @keywords internal
 //'
@@ -32,7 +33,8 @@
 // [[Rcpp::export]]
 Rcpp::NumericMatrix rotating (Rcpp::Reference P,
                               Rcpp::Nullable<Rcpp::NumericMatrix> T = R_NilValue,
-                              Rcpp::Nullable<int> seed = R_NilValue){
+                              Rcpp::Nullable<int> seed = R_NilValue,
+                              Rcpp::Nullable<std::string> method = R_NilValue){
 
     typedef double NT;
     typedef Cartesian<NT>    Kernel;
@@ -71,6 +73,15 @@ Rcpp::NumericMatrix rotating (Rcpp::Reference P,
                                       .time_since_epoch().count()
                                     : Rcpp::as<int>(seed);
 
+    bool hadamard = false;
+    if (method.isNotNull()) {
+        if (Rcpp::as<std::string>(method).compare(std::string("hadamard")) == 0) {
+            hadamard = true;
+        } else if (Rcpp::as<std::string>(method).compare(std::string("QR")) != 0) {
+            throw Rcpp::exception("Unknown rotation method!");
+        }
+    }
+
     switch (type) {
         case 1: {
             // Hpolytope
@@ -79,7 +90,8 @@ Rcpp::NumericMatrix rotating (Rcpp::Reference P,
                 TransorfMat = Rcpp::as<MT>(T);
                 HP.linear_transformIt(TransorfMat.inverse());
             } else {
-                TransorfMat = rotating < MT > (HP, seed_rcpp);
+                TransorfMat = (hadamard) ? hadamard_rotating < MT > (HP, seed_rcpp)
+                                         : rotating < MT > (HP, seed_rcpp);
             }
             Mat = extractMatPoly(HP);
             break;
@@ -91,7 +103,8 @@ Rcpp::NumericMatrix rotating (Rcpp::Reference P,
                 TransorfMat = Rcpp::as<MT>(T);
                 VP.linear_transformIt(TransorfMat.inverse());
             } else {
-                TransorfMat = rotating < MT > (VP, seed_rcpp);
+                TransorfMat = (hadamard) ? hadamard_rotating < MT > (VP, seed_rcpp)
+                                         : rotating < MT > (VP, seed_rcpp);
             }
             Mat = extractMatPoly(VP);
             break;
@@ -103,7 +116,8 @@ Rcpp::NumericMatrix rotating (Rcpp::Reference P,
                 TransorfMat = Rcpp::as<MT>(T);
                 ZP.linear_transformIt(TransorfMat.inverse());
             } else {
-                TransorfMat = rotating < MT > (ZP, seed_rcpp);
+                TransorfMat = (hadamard) ? hadamard_rotating < MT > (ZP, seed_rcpp)
+                                         : rotating < MT > (ZP, seed_rcpp);
             }
             Mat = extractMatPoly(ZP);
             break;
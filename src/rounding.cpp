@@ -24,6 +24,8 @@
 #include "preprocess/svd_rounding.hpp"
 #include "preprocess/inscribed_ellipsoid_rounding.hpp"
 #include "extractMatPoly.h"
+#include "cachedInnerBall.h"
+#include "sparseHpolytope.h"
 
 template
 <
@@ -39,13 +41,14 @@ std::tuple<MT, VT, NT> apply_rounding(Polytope &P,
                                       std::string const& method_rcpp,
                                       unsigned int const& walkL,
                                       std::pair<Point, NT> &InnerBall,
-                                      RNGType &rng)
+                                      RNGType &rng,
+                                      unsigned int const& num_threads)
 {
     std::tuple<MT, VT, NT> round_res;
     if (method_rcpp.compare(std::string("min_ellipsoid")) == 0) {
-        round_res = min_sampling_covering_ellipsoid_rounding<WalkType, MT, VT>(P, InnerBall, walkL, rng);
+        round_res = min_sampling_covering_ellipsoid_rounding<WalkType, MT, VT>(P, InnerBall, walkL, rng, num_threads);
     } else if (method_rcpp.compare(std::string("isotropy")) == 0) {
-        round_res = svd_rounding<WalkType, MT, VT>(P, InnerBall, walkL, rng);
+        round_res = svd_rounding<WalkType, MT, VT>(P, InnerBall, walkL, rng, num_threads);
     } else {
         throw Rcpp::exception("Unknown method!");
     }
@@ -54,9 +57,10 @@ std::tuple<MT, VT, NT> apply_rounding(Polytope &P,
 
 //' Internal rcpp function for the rounding of a convex polytope
 //'
-//' @param P A convex polytope (H- or V-representation or zonotope).
-//' @param method Optional. The method to use for rounding, a) \code{'min_ellipsoid'} for the method based on mimimmum volume enclosing ellipsoid of a uniform sample from P, b) \code{'max_ellipsoid'} for the method based on maximum volume enclosed ellipsoid in P, (c) \code{'isotropy'} for the method based on isotropy. The default method is \code{'min_ellipsoid'} for all the representations.
+//' @param P A convex polytope (H- or V-representation, zonotope or sparse H-polytope without equalities).
+//' @param method Optional. The method to use for rounding, a) \code{'min_ellipsoid'} for the method based on mimimmum volume enclosing ellipsoid of a uniform sample from P, b) \code{'max_ellipsoid'} for the method based on maximum volume enclosed ellipsoid in P, (c) \code{'isotropy'} for the method based on isotropy. The default method is \code{'min_ellipsoid'} for all the representations. A sparse H-polytope, whose finite bounds are added to its inequalities, is rounded only by \code{'max_ellipsoid'}, which is its default.
 //' @param seed Optional. A fixed seed for the number generator.
+//' @param num_threads Optional. The number of parallel chains that draw the samples of the \code{'min_ellipsoid'} and \code{'isotropy'} methods. The default value is \eqn{1}.
 //'
 //' @keywords internal
 //'
@@ -64,7 +68,8 @@ std::tuple<MT, VT, NT> apply_rounding(Polytope &P,
 // [[Rcpp::export]]
 Rcpp::List rounding (Rcpp::Reference P,
                      Rcpp::Nullable<std::string> method = R_NilValue,
-                     Rcpp::Nullable<double> seed = R_NilValue){
+                     Rcpp::Nullable<double> seed = R_NilValue,
+                     Rcpp::Nullable<unsigned int> num_threads = R_NilValue){
 
     typedef double NT;
     typedef Cartesian<NT>    Kernel;
@@ -75,6 +80,8 @@ Rcpp::List rounding (Rcpp::Reference P,
     typedef Zonotope<Point> zonotope;
     typedef Eigen::Matrix<NT,Eigen::Dynamic,1> VT;
     typedef Eigen::Matrix<NT,Eigen::Dynamic,Eigen::Dynamic> MT;
+    typedef Eigen::SparseMatrix<NT> SpMat;
+    typedef HPolytope<Point, SpMat> HpolytopeSparse;
 
     unsigned int n;
     unsigned int walkL=2;
@@ -93,16 +100,24 @@ Rcpp::List rounding (Rcpp::Reference P,
         type = 3;
     } else if (type_str.compare(std::string("VpolytopeIntersection")) == 0) {
         throw Rcpp::exception("volesti does not support roatation of this kind of representation.");
+    } else if (type_str.compare(std::string("HpolytopeSparse")) == 0) {
+        n = Rcpp::as<SpMat>(P.slot("Aineq")).cols();
+        type = 5;
     } else {
         throw Rcpp::exception("Unknown polytope representation!");
     }
 
-    std::string method_rcpp = std::string("isotropy");
+    // a sparse H-polytope is rounded only by its maximum inscribed ellipsoid, that
+    // keeps its matrix sparse
+    std::string method_rcpp = (type == 5) ? std::string("max_ellipsoid") : std::string("isotropy");
     if(method.isNotNull()) {
         method_rcpp =  Rcpp::as<std::string>(method);
-        if (method_rcpp.compare(std::string("max_ellipsoid")) == 0 && type != 1) {
+        if (method_rcpp.compare(std::string("max_ellipsoid")) == 0 && type != 1 && type != 5) {
             Rcpp::exception("This method can not be used for V- or Z-polytopes!");
         }
+        if (method_rcpp.compare(std::string("max_ellipsoid")) != 0 && type == 5) {
+            throw Rcpp::exception("Only the max_ellipsoid method can be used for sparse H-polytopes!");
+        }
     }
 
     RNGType rng(n);
@@ -111,6 +126,14 @@ Rcpp::List rounding (Rcpp::Reference P,
         rng.set_seed(seed_rcpp);
     }
 
+    unsigned int num_threads_rcpp = 1;
+    if (num_threads.isNotNull()) {
+        if (Rcpp::as<int>(num_threads) < 1) {
+            throw Rcpp::exception("The number of threads has to be a positive integer!");
+        }
+        num_threads_rcpp = Rcpp::as<int>(num_threads);
+    }
+
     std::pair <Point, NT> InnerBall;
     Rcpp::NumericMatrix Mat;
 
@@ -127,7 +150,7 @@ Rcpp::List rounding (Rcpp::Reference P,
             if (method_rcpp.compare(std::string("max_ellipsoid")) == 0) {
                 round_res = inscribed_ellipsoid_rounding<MT, VT, NT>(HP, InnerBall.first);
             } else {
-                round_res = apply_rounding<MT, VT, AcceleratedBilliardWalk>(HP, method_rcpp, walkL, InnerBall, rng);
+                round_res = apply_rounding<MT, VT, AcceleratedBilliardWalk>(HP, method_rcpp, walkL, InnerBall, rng, num_threads_rcpp);
             }
             Mat = extractMatPoly(HP);
             break;
@@ -135,24 +158,37 @@ Rcpp::List rounding (Rcpp::Reference P,
         case 2: {
             // Vpolytope
             Vpolytope VP(n, Rcpp::as<MT>(P.slot("V")), VT::Ones(Rcpp::as<MT>(P.slot("V")).rows()));
+            set_cached_inner_ball(P, VP);
             InnerBall = VP.ComputeInnerBall();
             if (InnerBall.second < 0.0) throw Rcpp::exception("Unable to compute a feasible point.");
-            round_res = apply_rounding<MT, VT, BilliardWalk>(VP, method_rcpp, walkL, InnerBall, rng);
+            round_res = apply_rounding<MT, VT, BilliardWalk>(VP, method_rcpp, walkL, InnerBall, rng, num_threads_rcpp);
             Mat = extractMatPoly(VP);
             break;
         }
         case 3: {
             // Zonotope
             zonotope ZP(n, Rcpp::as<MT>(P.slot("G")), VT::Ones(Rcpp::as<MT>(P.slot("G")).rows()));
+            set_cached_inner_ball(P, ZP);
             InnerBall = ZP.ComputeInnerBall();
             if (InnerBall.second < 0.0) throw Rcpp::exception("Unable to compute a feasible point.");
-            round_res = apply_rounding<MT, VT, BilliardWalk>(ZP, method_rcpp, walkL, InnerBall, rng);
+            round_res = apply_rounding<MT, VT, BilliardWalk>(ZP, method_rcpp, walkL, InnerBall, rng, num_threads_rcpp);
             Mat = extractMatPoly(ZP);
             break;
         }
         case 4: {
             throw Rcpp::exception("volesti does not support rounding for this representation currently.");
         }
+        case 5: {
+            // Sparse Hpolytope, the finite bounds lb <= x <= ub are appended to the inequalities
+            HpolytopeSparse HP = sparse_hpolytope<HpolytopeSparse>(P, "it can not be rounded.");
+            InnerBall = HP.ComputeInnerBall();
+            if (InnerBall.second < 0.0) throw Rcpp::exception("Unable to compute a feasible point.");
+            round_res = inscribed_ellipsoid_rounding<MT, VT, NT>(HP, InnerBall.first);
+            MT Mat_dense(HP.get_mat().rows(), n + 1);
+            Mat_dense << HP.get_vec(), MT(HP.get_mat());
+            Mat = Rcpp::wrap(Mat_dense);
+            break;
+        }
     }
 
     return Rcpp::List::create(Rcpp::Named("Mat") = Mat, Rcpp::Named("T") = Rcpp::wrap(std::get<0>(round_res)),
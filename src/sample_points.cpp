@@ -24,6 +24,7 @@
 #include "ode_solvers/ode_solvers.hpp"
 #include "oracle_functors_rcpp.h"
 #include "preprocess/crhmc/constraint_problem.h"
+#include "cachedInnerBall.h"
 
 enum random_walks {
   ball_walk,
@@ -60,7 +61,11 @@ void sample_from_polytope(Polytope &P, int type, RNGType &rng, PointList &randPo
                           Point const& StartingPoint, unsigned int const& nburns,
                           bool const& set_L, random_walks walk,
                           NegativeGradientFunctor *F=NULL, NegativeLogprobFunctor *f=NULL,
-                          HessianFunctor *h=NULL, ode_solvers solver_type = no_solver)
+                          HessianFunctor *h=NULL, ode_solvers solver_type = no_solver,
+                          bool const& rounding = false,
+                          std::string const& crhmc_cache_dir = std::string(),
+                          int const& crhmc_simd_len = 1,
+                          unsigned int const& crhmc_num_threads = 1)
 {
     switch (walk)
     {
@@ -127,7 +132,10 @@ void sample_from_polytope(Polytope &P, int type, RNGType &rng, PointList &randPo
         }
         break;
     case accelarated_billiard:
-        if(set_L) {
+        if (rounding) {
+            uniform_sampling_online_rounding<AcceleratedBilliardWalk>(randPoints, P, rng, walkL, numpoints,
+                                                                      StartingPoint, nburns);
+        } else if(set_L) {
             AcceleratedBilliardWalk WalkType(L);
             uniform_sampling(randPoints, P, rng, WalkType, walkL, numpoints, StartingPoint, nburns);
         } else {
@@ -203,8 +211,9 @@ void sample_from_polytope(Polytope &P, int type, RNGType &rng, PointList &randPo
         break;
     case crhmc:
         execute_crhmc<Polytope, RNGType, PointList, NegativeGradientFunctor,NegativeLogprobFunctor,
-                      HessianFunctor, CRHMCWalk, 1
-            >(P, rng, randPoints, walkL, numpoints, nburns, F, f, h);
+                      HessianFunctor, CRHMCWalk
+            >(P, rng, randPoints, walkL, numpoints, nburns, crhmc_simd_len, F, f, h, false, crhmc_cache_dir,
+              crhmc_num_threads);
         break;
     default:
         throw Rcpp::exception("Unknown random walk!");
@@ -238,6 +247,10 @@ bool is_walk(Rcpp::Nullable<Rcpp::List> random_walk, std::string str) {
 //' for logconcave densities with H-polytope and sparse constrainted problems.}
 //' \item{\code{walk_length}}{The number of the steps per generated point for the random walk. The default value is \eqn{1}.}
 //' \item{\code{nburns}}{The number of points to burn before start sampling. The default value is \eqn{1}.}
+//' \item{\code{rounding}}{A boolean parameter to round the polytope online while sampling with \code{'aBiW'} from the uniform distribution. The chain updates the covariance of its samples, including the burned ones, and the polytope is transformed by it after \eqn{10d} samples and then after every doubling of this period. The returned points are in the coordinates of P. The default value is \code{FALSE}.}
+//' \item{\code{preprocess_cache_dir}}{A directory to store the preprocessed problem of the \code{'CRHMC'} walk, i.e. the problem after the removal of dependent rows and fixed variables, the reordering of its rows and the computation of its Lewis center. A later call for the same polytope and density reads it from there instead of preprocessing the polytope again.}
+//' \item{\code{simdLen}}{The number of \code{'CRHMC'} chains that share each factorization of the Hessian, 1, 4 or 8. Every chain has its own random stream and its points are returned as a consecutive block of columns. The value \eqn{0} takes it from the cpu, i.e. 8 with AVX-512, 4 with AVX2 and 1 otherwise. The default value is \eqn{1}.}
+//' \item{\code{num_threads}}{The number of threads of the sparse Cholesky factorizations of \code{'CRHMC'}, in its steps and in the preprocessing of the polytope. The independent branches of the elimination tree are factorized in parallel. For the intersection of two V-polytopes, a value larger than \eqn{1} solves the linear programs of the two V-polytopes in two threads. The default value is \eqn{1}.}
 //' \item{\code{starting_point}}{A \eqn{d}-dimensional numerical vector that declares a starting point in the interior of the polytope for the random walk. The default choice is the center of the ball as that one computed by the function \code{inner_ball()}.}
 //' \item{\code{BaW_rad}}{The radius for the ball walk.}
 //' \item{\code{L}}{The maximum length of the billiard trajectory or the radius for the step of dikin, vaidya or john walk.}
@@ -634,6 +647,43 @@ Rcpp::NumericMatrix sample_points(Rcpp::Reference P,
         }
     }
 
+    bool rounding = false;
+    if (Rcpp::as<Rcpp::List>(random_walk).containsElementNamed("rounding")) {
+        rounding = Rcpp::as<bool>(Rcpp::as<Rcpp::List>(random_walk)["rounding"]);
+        if (rounding && (walk != accelarated_billiard || gaussian || logconcave || exponential)) {
+            throw Rcpp::exception("Online rounding is supported only for uniform sampling with the accelerated billiard walk!");
+        }
+        if (rounding && set_L) {
+            throw Rcpp::exception("The length of the billiard trajectory can not be set with online rounding!");
+        }
+    }
+
+    std::string crhmc_cache_dir;
+    if (Rcpp::as<Rcpp::List>(random_walk).containsElementNamed("preprocess_cache_dir")) {
+        if (walk != crhmc) throw Rcpp::exception("The preprocessing cache is used only by the CRHMC walk!");
+        crhmc_cache_dir = Rcpp::as<std::string>(Rcpp::as<Rcpp::List>(random_walk)["preprocess_cache_dir"]);
+    }
+
+    int crhmc_simd_len = 1;
+    if (Rcpp::as<Rcpp::List>(random_walk).containsElementNamed("simdLen")) {
+        if (walk != crhmc) throw Rcpp::exception("The simd length is used only by the CRHMC walk!");
+        crhmc_simd_len = Rcpp::as<int>(Rcpp::as<Rcpp::List>(random_walk)["simdLen"]);
+        if (crhmc_simd_len != 0 && crhmc_simd_len != 1 && crhmc_simd_len != 4 && crhmc_simd_len != 8) {
+            throw Rcpp::exception("The simd length of CRHMC has to be 0, 1, 4 or 8!");
+        }
+    }
+
+    unsigned int num_threads = 1;
+    if (Rcpp::as<Rcpp::List>(random_walk).containsElementNamed("num_threads")) {
+        if (walk != crhmc && type != 4) {
+            throw Rcpp::exception("The number of threads is used only by the CRHMC walk and for the intersection of two V-polytopes!");
+        }
+        if (Rcpp::as<int>(Rcpp::as<Rcpp::List>(random_walk)["num_threads"]) < 1) {
+            throw Rcpp::exception("The number of threads has to be a positive integer!");
+        }
+        num_threads = Rcpp::as<int>(Rcpp::as<Rcpp::List>(random_walk)["num_threads"]);
+    }
+
     switch(type) {
         case 1: {
             // Hpolytope
@@ -654,17 +704,20 @@ Rcpp::NumericMatrix sample_points(Rcpp::Reference P,
             }
             if (functor_defined) {
                 sample_from_polytope(HP, type, rng, randPoints, walkL, numpoints, gaussian, a, L, c,
-                    StartingPoint, nburns, set_L, walk, F, f, h, solver);
+                    StartingPoint, nburns, set_L, walk, F, f, h, solver, rounding, crhmc_cache_dir, crhmc_simd_len,
+                    num_threads);
             }
             else {
                 sample_from_polytope(HP, type, rng, randPoints, walkL, numpoints, gaussian, a, L, c,
-                    StartingPoint, nburns, set_L, walk, G, g, hess_g, solver);
+                    StartingPoint, nburns, set_L, walk, G, g, hess_g, solver, rounding, crhmc_cache_dir, crhmc_simd_len,
+                    num_threads);
             }
             break;
         }
         case 2: {
             // Vpolytope
             Vpolytope VP(dim, Rcpp::as<MT>(P.slot("V")), VT::Ones(Rcpp::as<MT>(P.slot("V")).rows()));
+            set_cached_inner_ball(P, VP);
 
             InnerBall = VP.ComputeInnerBall();
             if (InnerBall.second < 0.0) throw Rcpp::exception("Unable to compute a feasible point.");
@@ -679,12 +732,13 @@ Rcpp::NumericMatrix sample_points(Rcpp::Reference P,
                 VP.shift(mode.getCoefficients());
             }
             sample_from_polytope(VP, type, rng, randPoints, walkL, numpoints, gaussian, a, L, c,
-                                 StartingPoint, nburns, set_L, walk, F, f, h, solver);
+                                 StartingPoint, nburns, set_L, walk, F, f, h, solver, rounding);
             break;
         }
         case 3: {
             // Zonotope
             zonotope ZP(dim, Rcpp::as<MT>(P.slot("G")), VT::Ones(Rcpp::as<MT>(P.slot("G")).rows()));
+            set_cached_inner_ball(P, ZP);
 
             InnerBall = ZP.ComputeInnerBall();
             if (InnerBall.second < 0.0) throw Rcpp::exception("Unable to compute a feasible point.");
@@ -699,7 +753,7 @@ Rcpp::NumericMatrix sample_points(Rcpp::Reference P,
                 ZP.shift(mode.getCoefficients());
             }
             sample_from_polytope(ZP, type, rng, randPoints, walkL, numpoints, gaussian, a, L, c,
-                                 StartingPoint, nburns, set_L, walk, F, f, h, solver);
+                                 StartingPoint, nburns, set_L, walk, F, f, h, solver, rounding);
             break;
         }
         case 4: {
@@ -709,6 +763,7 @@ Rcpp::NumericMatrix sample_points(Rcpp::Reference P,
             Vpolytope VP2(dim, Rcpp::as<MT>(P.slot("V2")),
                      VT::Ones(Rcpp::as<MT>(P.slot("V2")).rows()));
             InterVP VPcVP(VP1, VP2);
+            VPcVP.set_num_threads(num_threads);
 
             if (!VPcVP.is_feasible()) throw Rcpp::exception("Empty set!");
             InnerBall = VPcVP.ComputeInnerBall();
@@ -722,7 +777,7 @@ Rcpp::NumericMatrix sample_points(Rcpp::Reference P,
                 VPcVP.shift(mode.getCoefficients());
             }
             sample_from_polytope(VPcVP, type, rng, randPoints, walkL, numpoints, gaussian, a, L, c,
-                                 StartingPoint, nburns, set_L, walk, F, f, h, solver);
+                                 StartingPoint, nburns, set_L, walk, F, f, h, solver, rounding);
             break;
         }
         case 5: {
@@ -737,13 +792,13 @@ Rcpp::NumericMatrix sample_points(Rcpp::Reference P,
             if(walk!=crhmc){throw Rcpp::exception("Sparse problems are supported only by the CRHMC walk.");}
             if (functor_defined) {
                 execute_crhmc<sparse_problem, RNGType, std::list<Point>, RcppFunctor::GradientFunctor<Point>,
-                              RcppFunctor::FunctionFunctor<Point>, RcppFunctor::HessianFunctor<Point>, CRHMCWalk, 1>
-                    (problem, rng, randPoints, walkL, numpoints, nburns, F, f, h);
+                              RcppFunctor::FunctionFunctor<Point>, RcppFunctor::HessianFunctor<Point>, CRHMCWalk>
+                    (problem, rng, randPoints, walkL, numpoints, nburns, crhmc_simd_len, F, f, h, false, crhmc_cache_dir, num_threads);
             }
             else {
                 execute_crhmc<sparse_problem, RNGType, std::list<Point>, GaussianFunctor::GradientFunctor<Point>,
-                              GaussianFunctor::FunctionFunctor<Point>, GaussianFunctor::HessianFunctor<Point>, CRHMCWalk, 1>
-                    (problem, rng, randPoints, walkL, numpoints, nburns, G, g, hess_g);
+                              GaussianFunctor::FunctionFunctor<Point>, GaussianFunctor::HessianFunctor<Point>, CRHMCWalk>
+                    (problem, rng, randPoints, walkL, numpoints, nburns, crhmc_simd_len, G, g, hess_g, false, crhmc_cache_dir, num_threads);
             }
             break;
         }
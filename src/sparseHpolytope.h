@@ -0,0 +1,56 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2024 Vissarion Fisikopoulos
+// Copyright (c) 2018-2024 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+
+#ifndef SPARSEHPOLYTOPE_H
+#define SPARSEHPOLYTOPE_H
+
+// Build the sparse H-polytope Ax <= b of an R object of class HpolytopeSparse without
+// equalities; the finite bounds are appended to the inequalities, for each coordinate
+// x_j <= ub_j and then -x_j <= -lb_j
+template <class Polytope>
+Polytope sparse_hpolytope(Rcpp::Reference P, std::string const& task) {
+
+    typedef typename Polytope::MT MT;
+    typedef typename Polytope::VT VT;
+    typedef typename Polytope::NT NT;
+
+    if (Rcpp::as<MT>(P.slot("Aeq")).rows() > 0) {
+        throw Rcpp::exception(("The polytope has equality constraints, " + task).c_str());
+    }
+    MT Aineq = Rcpp::as<MT>(P.slot("Aineq"));
+    VT bineq = Rcpp::as<VT>(P.slot("bineq")), lb = Rcpp::as<VT>(P.slot("lb")),
+       ub = Rcpp::as<VT>(P.slot("ub"));
+    unsigned int n = Aineq.cols();
+
+    std::vector<Eigen::Triplet<NT>> trp;
+    trp.reserve(Aineq.nonZeros() + 2 * n);
+    for (int k = 0; k < Aineq.outerSize(); ++k) {
+        for (typename MT::InnerIterator it(Aineq, k); it; ++it) {
+            trp.push_back(Eigen::Triplet<NT>(it.row(), it.col(), it.value()));
+        }
+    }
+    std::vector<NT> b;
+    b.reserve(Aineq.rows() + 2 * n);
+    b.insert(b.end(), bineq.data(), bineq.data() + bineq.size());
+    for (unsigned int j = 0; j < n; ++j) {
+        if (j < ub.size() && std::isfinite(ub(j))) {
+            trp.push_back(Eigen::Triplet<NT>(b.size(), j, NT(1)));
+            b.push_back(ub(j));
+        }
+        if (j < lb.size() && std::isfinite(lb(j))) {
+            trp.push_back(Eigen::Triplet<NT>(b.size(), j, NT(-1)));
+            b.push_back(-lb(j));
+        }
+    }
+    MT A(b.size(), n);
+    A.setFromTriplets(trp.begin(), trp.end());
+
+    return Polytope(n, A, Eigen::Map<VT>(b.data(), b.size()));
+}
+
+#endif
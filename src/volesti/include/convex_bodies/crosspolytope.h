@@ -0,0 +1,293 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2024 Vissarion Fisikopoulos
+// Copyright (c) 2018-2024 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+#ifndef CROSSPOLYTOPE_H
+#define CROSSPOLYTOPE_H
+
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <Eigen/Eigen>
+
+
+/// This class describes a cross polytope P = {x : ||T(x - c)||_1 <= 1} by its membership
+/// and boundary oracles. Its 2^d facets are never stored, thus it can be used in
+/// dimensions where the H-representation of generate_cross cannot be allocated.
+/// As in VPolytope there is no stored facet, so num_of_hyperplanes() returns 0 and the
+/// reflections of the billiard walk are computed from the boundary point.
+/// \tparam Point Point type
+template <typename Point>
+class CrossPolytope {
+public:
+    typedef Point                                             PointType;
+    typedef typename Point::FT                                NT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, 1>              VT;
+
+private:
+    unsigned int         _d;  //dimension
+    VT                   _c;  //center
+    MT                   _T;  //linear map, used only if _transformed is true
+    bool                 _transformed = false;
+    std::pair<Point, NT> _inner_ball;
+
+    VT map(VT const& x) const
+    {
+        return _transformed ? VT(_T * x) : x;
+    }
+
+    // the largest t >= 0 s.t. ||u + t w||_1 <= 1, given ||u||_1 <= 1
+    // f(t) = ||u + t w||_1 is convex and piecewise linear with breakpoints -u_i/w_i,
+    // so we walk over the positive breakpoints in increasing order
+    static NT positive_intersect(VT const& u, VT const& w)
+    {
+        std::vector<std::pair<NT, NT>> breaks; // (breakpoint, |w_i|)
+        NT f = NT(0), slope = NT(0);
+
+        for (int i = 0; i < u.size(); ++i) {
+            f += std::abs(u(i));
+            if (w(i) == NT(0)) continue;
+            if (u(i) == NT(0)) {
+                slope += std::abs(w(i));
+            } else {
+                slope += (u(i) > NT(0)) ? w(i) : -w(i);
+                NT t = -u(i) / w(i);
+                if (t > NT(0)) breaks.push_back(std::make_pair(t, std::abs(w(i))));
+            }
+        }
+        if (slope == NT(0) && breaks.empty()) return std::numeric_limits<NT>::max();
+        std::sort(breaks.begin(), breaks.end());
+
+        NT t0 = NT(0);
+        for (auto const& br : breaks) {
+            if (slope > NT(0) && f + slope * (br.first - t0) >= NT(1)) {
+                return t0 + (NT(1) - f) / slope;
+            }
+            f += slope * (br.first - t0);
+            t0 = br.first;
+            // the i-th term changes sign, thus the slope increases by 2|w_i|
+            slope += NT(2) * br.second;
+        }
+        return t0 + (NT(1) - f) / slope;
+    }
+
+public:
+    CrossPolytope() {}
+
+    CrossPolytope(unsigned int const& dim) : _d(dim), _c(VT::Zero(dim))
+    {
+        _inner_ball = std::pair<Point, NT>(Point(_d), NT(1) / std::sqrt(NT(_d)));
+    }
+
+    std::pair<Point, NT> InnerBall() const
+    {
+        return _inner_ball;
+    }
+
+    void set_InnerBall(std::pair<Point, NT> const& innerball)
+    {
+        _inner_ball = innerball;
+    }
+
+    // The center c is the Chebychev center. For T = I the radius is the exact 1/sqrt(d),
+    // otherwise 1/(sqrt(d)||T||_2) is a lower bound of the distance to every facet
+    std::pair<Point, NT> ComputeInnerBall()
+    {
+        NT norm_T = NT(1);
+        if (_transformed) {
+            Eigen::JacobiSVD<MT> svd(_T);
+            norm_T = svd.singularValues()(0);
+        }
+        _inner_ball = std::pair<Point, NT>(Point(_c), NT(1) / (std::sqrt(NT(_d)) * norm_T));
+        return _inner_ball;
+    }
+
+    unsigned int dimension() const
+    {
+        return _d;
+    }
+
+    int num_of_hyperplanes() const
+    {
+        return 0;
+    }
+
+    int num_of_generators() const
+    {
+        return 0;
+    }
+
+    // the linear map T and the center c define P, e.g. for the keys of the schedule
+    // cache and of the checkpoints
+    MT get_mat() const
+    {
+        return _transformed ? _T : MT(MT::Identity(_d, _d));
+    }
+
+    VT get_vec() const
+    {
+        return _c;
+    }
+
+    bool is_normalized()
+    {
+        return true;
+    }
+
+    void normalize() {}
+
+    void print() const
+    {
+        std::cout << " " << _d << " dimensional cross polytope with center " << _c.transpose() << "\n";
+        if (_transformed) std::cout << " and linear map\n" << _T << "\n";
+    }
+
+    // return -1 if p is in P and 0 otherwise
+    int is_in(Point const& p, NT tol = NT(0)) const
+    {
+        if (map(p.getCoefficients() - _c).template lpNorm<1>() <= NT(1) + tol) {
+            return -1;
+        }
+        return 0;
+    }
+
+    // compute intersection points of the line r + t v with the boundary of P
+    std::pair<NT, NT> line_intersect(Point const& r, Point const& v) const
+    {
+        VT u = map(r.getCoefficients() - _c);
+        VT w = map(v.getCoefficients());
+        return std::pair<NT, NT>(positive_intersect(u, w), -positive_intersect(u, -w));
+    }
+
+    std::pair<NT, NT> line_intersect(Point const& r, Point const& v, VT &Ar,
+                                     VT &Av, bool pos = false) const
+    {
+        return line_intersect(r, v);
+    }
+
+    std::pair<NT, NT> line_intersect(Point const& r, Point const& v, VT &Ar,
+                                     VT &Av, NT const& lambda_prev, bool pos = false) const
+    {
+        return line_intersect(r, v);
+    }
+
+    std::pair<NT, int> line_positive_intersect(Point const& r, Point const& v) const
+    {
+        VT u = map(r.getCoefficients() - _c);
+        VT w = map(v.getCoefficients());
+        return std::pair<NT, int>(positive_intersect(u, w), 1);
+    }
+
+    std::pair<NT, int> line_positive_intersect(Point const& r, Point const& v, VT &Ar,
+                                               VT &Av) const
+    {
+        return line_positive_intersect(r, v);
+    }
+
+    std::pair<NT, int> line_positive_intersect(Point const& r, Point const& v, VT &Ar,
+                                               VT &Av, NT const& lambda_prev) const
+    {
+        return line_positive_intersect(r, v);
+    }
+
+    //-------------------------accelarated billiard--------------------------------//
+    template <typename update_parameters>
+    std::pair<NT, int> line_first_positive_intersect(Point const& r,
+                                                     Point const& v,
+                                                     VT& Ar,
+                                                     VT& Av,
+                                                     update_parameters &params) const
+    {
+        return line_positive_intersect(r, v);
+    }
+
+    template <typename update_parameters>
+    std::pair<NT, int> line_positive_intersect(Point const& r,
+                                               Point const& v,
+                                               VT& Ar,
+                                               VT& Av,
+                                               NT const& lambda_prev,
+                                               MT const& AA,
+                                               update_parameters &params) const
+    {
+        return line_positive_intersect(r, v);
+    }
+
+    template <typename update_parameters>
+    std::pair<NT, int> line_positive_intersect(Point const& r,
+                                               Point const& v,
+                                               VT& Ar,
+                                               VT& Av,
+                                               NT const& lambda_prev,
+                                               update_parameters &params) const
+    {
+        return line_positive_intersect(r, v);
+    }
+    //------------------------------------------------------------------------------//
+
+    // compute intersection points of a ray starting from r and parallel to the rand_coord-th axis
+    std::pair<NT, NT> line_intersect_coord(Point const& r,
+                                           unsigned int const& rand_coord,
+                                           VT &lamdas) const
+    {
+        VT u = map(r.getCoefficients() - _c);
+        VT w = _transformed ? VT(_T.col(rand_coord)) : VT(VT::Unit(_d, rand_coord));
+        return std::pair<NT, NT>(positive_intersect(u, w), -positive_intersect(u, -w));
+    }
+
+    std::pair<NT, NT> line_intersect_coord(Point const& r,
+                                           Point const& r_prev,
+                                           unsigned int const& rand_coord,
+                                           unsigned int const& rand_coord_prev,
+                                           VT &lamdas) const
+    {
+        return line_intersect_coord(r, rand_coord, lamdas);
+    }
+
+    // the facet that contains p has normal T^T sign(T(p - c))
+    void compute_reflection(Point &v, Point const& p, int const& facet) const
+    {
+        VT s = map(p.getCoefficients() - _c).cwiseSign();
+        VT a = _transformed ? VT(_T.transpose() * s) : s;
+        Point n(a / a.norm());
+
+        v += n * (-2.0 * v.dot(n));
+    }
+
+    template <typename update_parameters>
+    void compute_reflection(Point &v, Point const& p, update_parameters const& params) const
+    {
+        compute_reflection(v, p, params.facet_prev);
+    }
+
+    // shift P by -c, i.e. P <- P - c
+    void shift(VT const& c)
+    {
+        _c -= c;
+        _inner_ball.first = Point(VT(_inner_ball.first.getCoefficients() - c));
+    }
+
+    // apply the linear map x <- T^{-1} x, i.e. P <- {x : Tx in P}
+    void linear_transformIt(MT const& T)
+    {
+        _T = _transformed ? MT(_T * T) : T;
+        _c = T.inverse() * _c;
+        _transformed = true;
+        ComputeInnerBall();
+    }
+
+    template <typename T>
+    bool get_points_for_rounding (T const& /*randPoints*/)
+    {
+        return false;
+    }
+
+    void free_them_all() {}
+};
+
+#endif
@@ -139,13 +139,20 @@ public:
     //First try using max_inscribed_ball
     //Use LpSolve library if it fails
     std::pair<Point, NT> ComputeInnerBall()
+    {
+        return ComputeInnerBall(Point(_d));
+    }
+
+    // The interior point method starts from x0, e.g. the center of the ball of a
+    // polytope that differs slightly from this one, which saves iterations
+    std::pair<Point, NT> ComputeInnerBall(Point const& x0)
     {
         normalize();
         if (!has_ball) {
             
             has_ball = true;
             NT const tol = 1e-08;
-            std::tuple<VT, NT, bool> inner_ball = max_inscribed_ball(A, b, 5000, tol);
+            std::tuple<VT, NT, bool> inner_ball = max_inscribed_ball(A, b, x0.getCoefficients(), 5000, tol);
 
             // check if the solution is feasible
             if (is_in(Point(std::get<0>(inner_ball))) == 0 || std::get<1>(inner_ball) < tol/2.0 ||
@@ -316,6 +323,10 @@ public:
     //Check if Point p is in H-polytope P:= Ax<=b
     int is_in(Point const& p, NT tol=NT(0)) const
     {
+        if constexpr (!std::is_same<MT, DenseMT>::value) {
+            // a row of a column-major sparse matrix is gathered from all its columns
+            return ((b - A * p.getCoefficients()).minCoeff() < NT(-tol)) ? 0 : -1;
+        }
         int m = A.rows();
         const NT* b_data = b.data();
 
@@ -957,13 +968,27 @@ public:
     {
         if(normalized)
             return;
-        NT row_norm;
-        for (int i = 0; i < A.rows(); ++i) {
-            row_norm = A.row(i).norm();
-            if (row_norm != 0.0) {
-                A.row(i) /= row_norm;
-                b(i) /= row_norm;
+        if constexpr (std::is_same<MT, DenseMT>::value) {
+            NT row_norm;
+            for (int i = 0; i < A.rows(); ++i) {
+                row_norm = A.row(i).norm();
+                if (row_norm != 0.0) {
+                    A.row(i) /= row_norm;
+                    b(i) /= row_norm;
+                }
+            }
+        } else {
+            // compute all the row norms in one pass over the nonzeros, the rows
+            // of a column-major matrix are not stored contiguously
+            VT row_norms = VT::Zero(A.rows());
+            for (int k = 0; k < A.outerSize(); ++k) {
+                for (typename MT::InnerIterator it(A, k); it; ++it) {
+                    row_norms(MT::IsRowMajor ? k : it.row()) += it.value() * it.value();
+                }
             }
+            VT scale = (row_norms.array() > 0.0).select(row_norms.array().sqrt().inverse(), NT(1)).matrix();
+            A = scale.asDiagonal() * A;
+            b = b.cwiseProduct(scale);
         }
         normalized = true;
     }
@@ -18,6 +18,9 @@
 #include "sampling/sphere.hpp"
 
 /// This class represents the intersection of two V-polytopes
+/// The oracles solve the linear programs of the two V-polytopes concurrently if
+/// set_num_threads() allows two threads, one after the other otherwise; each
+/// V-polytope keeps its own persistent ray-shooting model
 /// \tparam VPolytope VPolytope Type
 /// \tparam RNGType RNGType Type
 template <typename VPolytope, typename RNGType>
@@ -33,6 +36,9 @@ public:
     NT rad;
     VPolytope P1;
     VPolytope P2;
+    // 2 runs the LPs of the two V-polytopes in two threads; an OpenMP region per
+    // oracle call pays off only for LPs with many vertices
+    unsigned int num_threads = 1;
 
     IntersectionOfVpoly(): P1(), P2() {}
 
@@ -52,10 +58,25 @@ public:
         return _inner_ball;
     }
 
+    void set_num_threads(unsigned int const& threads) {
+        num_threads = threads;
+    }
+
     int is_in(const Point &p, NT tol=NT(0)) const {
-        if(P1.is_in(p)==-1)
-            return P2.is_in(p);
-        return 0;
+        if (num_threads < 2) {
+            if (P1.is_in(p) == -1)
+                return P2.is_in(p);
+            return 0;
+        }
+        int in1, in2;
+        #pragma omp parallel sections num_threads(2) if(num_threads > 1)
+        {
+            #pragma omp section
+            in1 = P1.is_in(p);
+            #pragma omp section
+            in2 = P2.is_in(p);
+        }
+        return (in1 == -1) ? in2 : 0;
     }
 
 
@@ -230,8 +251,14 @@ public:
     // with the V-polytope
     std::pair<NT,NT> line_intersect(const Point &r, const Point &v) const {
 
-        std::pair <NT, NT> P1pair = P1.line_intersect(r, v);
-        std::pair <NT, NT> P2pair = P2.line_intersect(r, v);
+        std::pair <NT, NT> P1pair, P2pair;
+        #pragma omp parallel sections num_threads(2) if(num_threads > 1)
+        {
+            #pragma omp section
+            P1pair = P1.line_intersect(r, v);
+            #pragma omp section
+            P2pair = P2.line_intersect(r, v);
+        }
         return std::pair<NT, NT>(std::min(P1pair.first, P2pair.first),
                                  std::max(P1pair.second, P2pair.second));
 
@@ -254,8 +281,14 @@ public:
 
     std::pair<NT, int> line_positive_intersect(const Point &r, const Point &v) const {
 
-        std::pair<NT, int> P1pair = P1.line_positive_intersect(r, v);
-        std::pair<NT, int> P2pair = P2.line_positive_intersect(r, v);
+        std::pair<NT, int> P1pair, P2pair;
+        #pragma omp parallel sections num_threads(2) if(num_threads > 1)
+        {
+            #pragma omp section
+            P1pair = P1.line_positive_intersect(r, v);
+            #pragma omp section
+            P2pair = P2.line_positive_intersect(r, v);
+        }
 
         if(P1pair.first < P2pair.first) {
             return std::pair<NT, int>(P1pair.first, 1);
@@ -315,8 +348,14 @@ public:
     std::pair<NT,NT> line_intersect_coord(const Point &r,
                                           const unsigned int &rand_coord,
                                           const VT &lamdas) const {
-        std::pair <NT, NT> P1pair = P1.line_intersect_coord(r, rand_coord, lamdas);
-        std::pair <NT, NT> P2pair = P2.line_intersect_coord(r, rand_coord, lamdas);
+        std::pair <NT, NT> P1pair, P2pair;
+        #pragma omp parallel sections num_threads(2) if(num_threads > 1)
+        {
+            #pragma omp section
+            P1pair = P1.line_intersect_coord(r, rand_coord, lamdas);
+            #pragma omp section
+            P2pair = P2.line_intersect_coord(r, rand_coord, lamdas);
+        }
         return std::pair<NT, NT>(std::min(P1pair.first, P2pair.first),
                                  std::max(P1pair.second, P2pair.second));
     }
@@ -17,6 +17,7 @@
 #include <Eigen/Eigen>
 
 #include "lp_oracles/vpolyoracles.h"
+#include "convex_bodies/vpolytope_membership_cache.h"
 #include <minimum_ellipsoid/khach.h>
 
 
@@ -36,10 +37,17 @@ private:
     MT                   V;  //matrix V. Each row contains a vertex
     VT                   b;  // vector b that contains first column of ine file
     std::pair<Point, NT> _inner_ball;
+    bool                 _inner_ball_known = false; // true when _inner_ball is an inscribed ball
 
     // TODO: Why don't we use std::vector<REAL>  and std::vector<int> for these pointers?
-    REAL *conv_comb, *conv_comb2, *conv_mem, *row;
-    int *colno, *colno_mem;
+    REAL *conv_comb, *conv_comb2, *row;
+    int *colno;
+
+    // simplices learned from the certificates of previous membership LPs
+    mutable VPolytopeMembershipCache<NT> membership_cache;
+
+    // persistent model of the ray-shooting LP, convex combinations of the vertices
+    mutable RayShootingLP<NT> ray_lp{0.0, 1.0, true};
 
 public:
     VPolytope() {}
@@ -48,10 +56,8 @@ public:
             _d{dim}, V{_V}, b{_b},
             conv_comb{new REAL[V.rows() + 1]},
             conv_comb2{new REAL[V.rows() + 1]},
-            conv_mem{new REAL[V.rows()]},
             row{new REAL[V.rows() + 1]},
-            colno{new int[V.rows() + 1]},
-            colno_mem{new int[V.rows()]}
+            colno{new int[V.rows() + 1]}
     {
     }
 
@@ -71,10 +77,8 @@ public:
         }
         conv_comb = new REAL[Pin.size()];
         conv_comb2 = new REAL[Pin.size()];
-        conv_mem = new REAL[V.rows()];
         row = new REAL[V.rows() + 1];
         colno = new int[V.rows() + 1];
-        colno_mem = new int[V.rows()];
     }
 
     template <typename T>
@@ -93,13 +97,15 @@ public:
             _d = other._d;
             V = other.V;
             b = other.b;
+            _inner_ball = other._inner_ball;
+            _inner_ball_known = other._inner_ball_known;
+            membership_cache = other.membership_cache;
+            ray_lp.clear();
 
             copy_array(other.conv_comb, conv_comb, V.rows() + 1);
             copy_array(other.conv_comb2, conv_comb2, V.rows() + 1);
-            copy_array(other.conv_mem, conv_mem, V.rows());
             copy_array(other.row, row, V.rows() + 1);
             copy_array(other.colno, colno, V.rows() + 1);
-            copy_array(other.colno_mem, colno_mem, V.rows());
         }
         return *this;
     }
@@ -110,13 +116,15 @@ public:
             _d = other._d;
             V = other.V;
             b = other.b;
+            _inner_ball = other._inner_ball;
+            _inner_ball_known = other._inner_ball_known;
+            membership_cache = std::move(other.membership_cache);
+            ray_lp.clear();
 
             conv_comb = other.conv_comb;  other.conv_comb = nullptr;
             conv_comb2 = other.conv_comb2;  other.conv_comb2 = nullptr;
-            conv_mem = other.conv_mem;  other.conv_mem = nullptr;
             row = other.row; other.row = nullptr;
-            colno = other.colno; colno = nullptr;
-            colno_mem = other.colno_mem; colno_mem = nullptr;
+            colno = other.colno; other.colno = nullptr;
         }
         return *this;
     }
@@ -124,41 +132,36 @@ public:
 
     VPolytope(const VPolytope& other) :
             _d{other._d}, V{other.V}, b{other.b},
+            _inner_ball{other._inner_ball}, _inner_ball_known{other._inner_ball_known},
             conv_comb{new REAL[V.rows() + 1]},
             conv_comb2{new REAL[V.rows() + 1]},
-            conv_mem{new REAL[V.rows()]},
             row{new REAL[V.rows() + 1]},
             colno{new int[V.rows() + 1]},
-            colno_mem{new int[V.rows()]}
+            membership_cache{other.membership_cache}
     {
         std::copy_n(other.conv_comb, V.rows() + 1, conv_comb);
         std::copy_n(other.conv_comb2, V.rows() + 1, conv_comb2);
-        std::copy_n(other.conv_mem, V.rows(), conv_mem);
         std::copy_n(other.row, V.rows() + 1, row);
         std::copy_n(other.colno, V.rows() + 1, colno);
-        std::copy_n(other.colno_mem, V.rows(), colno_mem);
     }
 
     VPolytope(VPolytope&& other) :
             _d{other._d}, V{other.V}, b{other.b},
-            conv_comb{nullptr}, conv_comb2{nullptr}, conv_mem{nullptr}, row{nullptr},
-            colno{nullptr}, colno_mem{nullptr}
+            _inner_ball{other._inner_ball}, _inner_ball_known{other._inner_ball_known},
+            conv_comb{nullptr}, conv_comb2{nullptr}, row{nullptr}, colno{nullptr},
+            membership_cache{std::move(other.membership_cache)}
     {
         conv_comb = other.conv_comb;  other.conv_comb = nullptr;
         conv_comb2 = other.conv_comb2;  other.conv_comb2 = nullptr;
-        conv_mem = other.conv_mem;  other.conv_mem = nullptr;
         row = other.row; other.row = nullptr;
-        colno = other.colno; colno = nullptr;
-        colno_mem = other.colno_mem; colno_mem = nullptr;
+        colno = other.colno; other.colno = nullptr;
     }
 
     ~VPolytope() {
         delete [] conv_comb;
         delete [] conv_comb2;
         delete [] colno;
-        delete [] colno_mem;
         delete [] row;
-        delete [] conv_mem;
     }
 
     std::pair<Point,NT> InnerBall() const
@@ -166,14 +169,17 @@ public:
         return _inner_ball;
     }
 
+    // set an inscribed ball, e.g. a previously computed one, that ComputeInnerBall() returns
     void set_InnerBall(std::pair<Point,NT> const& innerball) //const
     {
         _inner_ball = innerball;
+        _inner_ball_known = innerball.second > 0.0;
     }
 
     void set_interior_point(Point const& r)
     {
         _inner_ball.first = r;
+        _inner_ball_known = false;
     }
 
     // return dimension
@@ -220,6 +226,19 @@ public:
     // change the matrix V
     void set_mat(const MT &V2) {
         V = V2;
+        _inner_ball_known = false;
+        membership_cache.clear();
+        ray_lp.clear();
+    }
+
+    // set the maximum number of simplices kept by the membership cache, 0 disables it
+    void set_membership_cache_size(unsigned int const& size) {
+        membership_cache.set_max_size(size);
+    }
+
+    // the number of membership queries answered without an LP
+    unsigned long membership_cache_hits() const {
+        return membership_cache.hits();
     }
 
     // change the vector b
@@ -350,8 +369,14 @@ public:
     }*/
 
 
+    // compute an inscribed ball by shooting the coordinate rays from the center of the
+    // minimum volume enclosing ellipsoid of the vertices (or from the mean of the vertices);
+    // the ray shootings run in parallel
+    // the ball is computed once, unless the polytope changes
     std::pair<Point,NT> ComputeInnerBall() {
 
+        if (_inner_ball_known) return _inner_ball;
+
         NT radius =  std::numeric_limits<NT>::max(), min_plus;
         Point center(_d);
 
@@ -382,25 +407,47 @@ public:
             for(unsigned int i=0; i<_d; i++) center.set_coord(i, NT(c2(i)));
         }
 
-        std::pair<NT,NT> res;
-        Point v(_d);
-        for (unsigned int i = 0; i < _d; ++i) {
-            v.set_to_origin();
+        std::vector<NT> min_plus_per_ray(_d);
+        #pragma omp parallel for
+        for (int i = 0; i < int(_d); ++i) {
+            std::vector<REAL> row_ray(V.rows() + 1);
+            std::vector<int> colno_ray(V.rows() + 1);
+            Point v(_d);
             v.set_coord(i, 1.0);
-            res = intersect_double_line_Vpoly<NT>(V, center, v, row, colno);
-            min_plus = std::min(res.first, -1.0*res.second);
+            std::pair<NT,NT> res = intersect_double_line_Vpoly<NT>(V, center, v, row_ray.data(),
+                                                                   colno_ray.data());
+            min_plus_per_ray[i] = std::min(res.first, -1.0*res.second);
+        }
+        for (unsigned int i = 0; i < _d; ++i) {
+            min_plus = min_plus_per_ray[i];
             if (min_plus < radius) radius = min_plus;
         }
 
         radius = radius / std::sqrt(NT(_d));
-        _inner_ball = std::pair<Point, NT> (center, radius);
+        set_InnerBall(std::pair<Point, NT> (center, radius));
         return std::pair<Point, NT> (center, radius);
     }
 
 
     // check if point p belongs to the convex hull of V-Polytope P
+    // the LP is solved only if p does not lie in a cached simplex; its basic solution
+    // gives the simplex that the cache learns
+    // the buffers of the LP are kept per thread, thus walks that share the polytope
+    // can call it concurrently and a query allocates only inside lp_solve
     int is_in(const Point &p, NT tol=NT(0)) const {
-        if (memLP_Vpoly(V, p, conv_mem, colno_mem)){
+        static thread_local std::vector<REAL> row_mem;
+        static thread_local std::vector<int> colno_mem, support;
+        row_mem.resize(std::max(V.rows(), Eigen::Index(_d + 1)));
+        colno_mem.resize(row_mem.size());
+
+        if (membership_cache.max_size() == 0) {
+            return memLP_Vpoly(V, p, row_mem.data(), colno_mem.data()) ? -1 : 0;
+        }
+        if (membership_cache.is_in(p.getCoefficients())) {
+            return -1;
+        }
+        if (memLP_Vpoly_support(V, p, row_mem.data(), colno_mem.data(), support)){
+            membership_cache.add(V, support, p.getCoefficients());
             return -1;
         }
         return 0;
@@ -411,7 +458,7 @@ public:
     // with the V-polytope
     std::pair<NT,NT> line_intersect(const Point &r, const Point &v) const {
 
-        return intersect_double_line_Vpoly<NT>(V, r, v, row, colno);
+        return ray_lp.intersect_line(V, r, v);
     }
 
 
@@ -419,7 +466,7 @@ public:
     // with the V-polytope
     std::pair<NT,NT> line_intersect(const Point &r, const Point &v, const VT &Ar,
             const VT &Av) const {
-        return intersect_double_line_Vpoly<NT>(V, r, v,  row, colno);
+        return ray_lp.intersect_line(V, r, v);
     }
 
     // compute intersection point of ray starting from r and pointing to v
@@ -427,7 +474,7 @@ public:
     std::pair<NT,NT> line_intersect(const Point &r, const Point &v, const VT &Ar,
                                     const VT &Av, const NT &lambda_prev) const {
 
-        return intersect_double_line_Vpoly<NT>(V, r, v,  row, colno);
+        return ray_lp.intersect_line(V, r, v);
     }
 
 
@@ -489,7 +536,7 @@ public:
                                           const VT &lamdas) const {
         Point v(_d);
         v.set_coord(rand_coord, 1.0);
-        return intersect_double_line_Vpoly<NT>(V, r, v,  row, colno);
+        return ray_lp.intersect_line(V, r, v);
     }
 
 
@@ -544,6 +591,9 @@ public:
     void shift(const VT &c) {
         MT V2 = V.transpose().colwise() - c;
         V = V2.transpose();
+        if (_inner_ball_known) _inner_ball.first -= c;
+        membership_cache.clear();
+        ray_lp.clear();
     }
 
 
@@ -551,6 +601,9 @@ public:
     void linear_transformIt(const MT &T) {
         MT V2 = T.inverse() * V.transpose();
         V = V2.transpose();
+        _inner_ball_known = false;
+        membership_cache.clear();
+        ray_lp.clear();
     }
 
 
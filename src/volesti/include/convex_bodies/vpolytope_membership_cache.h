@@ -0,0 +1,164 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2024 Vissarion Fisikopoulos
+// Copyright (c) 2018-2024 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+#ifndef VPOLYTOPE_MEMBERSHIP_CACHE_H
+#define VPOLYTOPE_MEMBERSHIP_CACHE_H
+
+#include <list>
+#include <mutex>
+#include <vector>
+#include <Eigen/Eigen>
+
+
+/// A bounded cache of full dimensional simplices spanned by vertices of a V-polytope.
+/// Each simplex is the support of the certificate of a membership LP that answered
+/// "inside", so every point of it lies in the polytope. Queries that fall in a cached
+/// simplex are answered without solving an LP. The most recently used simplices are
+/// kept in front and the least recently used ones are dropped when the cache is full.
+/// Every access is locked, so the cache stays consistent when several threads query
+/// the same polytope.
+/// \tparam NT Numerical Type
+template <typename NT>
+class VPolytopeMembershipCache {
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, 1>              VT;
+
+    struct Simplex {
+        VT v0;     // the first vertex of the simplex
+        MT B_inv;  // inverse of the matrix with columns v_j - v0, j = 1,...,d
+    };
+
+    std::list<Simplex> simplices;
+    unsigned int       max_simplices;
+    unsigned long      num_hits = 0;
+    VT                 diff, lambda;  // workspace of the barycentric test
+    mutable std::mutex mutex;
+
+    // barycentric test; lambda holds the coordinates w.r.t. v_1,...,v_d
+    bool contains(Simplex const& S, VT const& p, NT const& tol)
+    {
+        diff = p - S.v0;
+        lambda.noalias() = S.B_inv * diff;
+        return lambda.minCoeff() >= -tol && lambda.sum() <= NT(1) + tol;
+    }
+
+public:
+    VPolytopeMembershipCache(unsigned int const& size = 64) : max_simplices(size) {}
+
+    VPolytopeMembershipCache(VPolytopeMembershipCache const& other)
+    {
+        std::lock_guard<std::mutex> lock(other.mutex);
+        simplices = other.simplices;
+        max_simplices = other.max_simplices;
+    }
+
+    VPolytopeMembershipCache(VPolytopeMembershipCache&& other)
+    {
+        std::lock_guard<std::mutex> lock(other.mutex);
+        simplices = std::move(other.simplices);
+        max_simplices = other.max_simplices;
+    }
+
+    VPolytopeMembershipCache& operator=(VPolytopeMembershipCache const& other)
+    {
+        if (this != &other) {
+            std::lock(mutex, other.mutex);
+            std::lock_guard<std::mutex> lock(mutex, std::adopt_lock);
+            std::lock_guard<std::mutex> lock_other(other.mutex, std::adopt_lock);
+            simplices = other.simplices;
+            max_simplices = other.max_simplices;
+            num_hits = 0;
+        }
+        return *this;
+    }
+
+    VPolytopeMembershipCache& operator=(VPolytopeMembershipCache&& other)
+    {
+        if (this != &other) {
+            std::lock(mutex, other.mutex);
+            std::lock_guard<std::mutex> lock(mutex, std::adopt_lock);
+            std::lock_guard<std::mutex> lock_other(other.mutex, std::adopt_lock);
+            simplices = std::move(other.simplices);
+            max_simplices = other.max_simplices;
+            num_hits = 0;
+        }
+        return *this;
+    }
+
+    void set_max_size(unsigned int const& size)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        max_simplices = size;
+        while (simplices.size() > max_simplices) simplices.pop_back();
+    }
+
+    unsigned int max_size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return max_simplices;
+    }
+
+    unsigned int size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return simplices.size();
+    }
+
+    // the number of queries answered by the cache
+    unsigned long hits() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return num_hits;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        simplices.clear();
+    }
+
+    // return true if p is certainly in the polytope
+    bool is_in(VT const& p)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = simplices.begin(); it != simplices.end(); ++it) {
+            if (contains(*it, p, NT(0))) {
+                simplices.splice(simplices.begin(), simplices, it);
+                num_hits++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // store the simplex spanned by the vertices in support, if it is full dimensional
+    // and contains the point p that the membership LP certified
+    template <typename MatrixType>
+    void add(MatrixType const& V, std::vector<int> const& support, VT const& p)
+    {
+        const unsigned int d = V.cols();
+        if (support.size() != d + 1) return;
+
+        Simplex S;
+        S.v0 = V.row(support[0]).transpose();
+        MT B(d, d);
+        for (unsigned int j = 1; j <= d; ++j) {
+            B.col(j - 1) = V.row(support[j]).transpose() - S.v0;
+        }
+        Eigen::FullPivLU<MT> lu(B);
+        if (!lu.isInvertible()) return;
+        S.B_inv = lu.inverse();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (max_simplices == 0 || !contains(S, p, NT(1e-8))) return;
+
+        simplices.push_front(std::move(S));
+        if (simplices.size() > max_simplices) simplices.pop_back();
+    }
+};
+
+#endif
@@ -35,6 +35,7 @@ private:
     VT                   b;  // vector b that contains first column of ine file
     MT                   T;
     std::pair<Point, NT> _inner_ball;
+    bool                 _inner_ball_known = false; // true when _inner_ball is an inscribed ball
     NT                   maxNT = std::numeric_limits<NT>::max();
     NT                   minNT = std::numeric_limits<NT>::lowest();
 
@@ -43,6 +44,9 @@ private:
     MT                   sigma;
     MT                   Q0;
 
+    // persistent model of the ray-shooting LP, coefficients of the generators in [-1,1]
+    mutable RayShootingLP<NT> ray_lp{-1.0, 1.0, false};
+
 
 public:
 
@@ -120,6 +124,9 @@ public:
             V = other.V;
             b = other.b;
             T = other.T;
+            _inner_ball = other._inner_ball;
+            _inner_ball_known = other._inner_ball_known;
+            ray_lp.clear();
 
             copy_array(other.conv_comb, conv_comb, V.rows() + 1);
             copy_array(other.row_mem, row_mem, V.rows());
@@ -137,12 +144,15 @@ public:
             V = other.V;
             b = other.b;
             T = other.T;
+            _inner_ball = other._inner_ball;
+            _inner_ball_known = other._inner_ball_known;
+            ray_lp.clear();
 
             conv_comb = other.conv_comb;  other.conv_comb = nullptr;
             row_mem = other.row_mem;  other.row_mem = nullptr;
             row = other.row; other.row = nullptr;
-            colno = other.colno; colno = nullptr;
-            colno_mem = other.colno_mem; colno_mem = nullptr;
+            colno = other.colno; other.colno = nullptr;
+            colno_mem = other.colno_mem; other.colno_mem = nullptr;
         }
         return *this;
     }
@@ -150,6 +160,7 @@ public:
 
     Zonotope(const Zonotope& other) :
             _d{other._d}, V{other.V}, b{other.b}, T{other.T},
+            _inner_ball{other._inner_ball}, _inner_ball_known{other._inner_ball_known},
             conv_comb{new REAL[V.rows() + 1]},
             row_mem{new REAL[V.rows()]},
             row{new REAL[V.rows() + 1]},
@@ -165,14 +176,15 @@ public:
 
     Zonotope(Zonotope&& other) :
             _d{other._d}, V{other.V}, b{other.b}, T{other.T},
+            _inner_ball{other._inner_ball}, _inner_ball_known{other._inner_ball_known},
             conv_comb{nullptr}, row_mem{nullptr}, row{nullptr},
             colno{nullptr}, colno_mem{nullptr}
     {
         conv_comb = other.conv_comb;  other.conv_comb = nullptr;
         row_mem = other.row_mem;  other.row_mem = nullptr;
         row = other.row; other.row = nullptr;
-        colno = other.colno; colno = nullptr;
-        colno_mem = other.colno_mem; colno_mem = nullptr;
+        colno = other.colno; other.colno = nullptr;
+        colno_mem = other.colno_mem; other.colno_mem = nullptr;
     }
 
     ~Zonotope() {
@@ -186,6 +198,7 @@ public:
     void set_interior_point(Point const& r)
     {
         _inner_ball.first = r;
+        _inner_ball_known = false;
     }
 
     // return the dimension
@@ -276,9 +289,11 @@ public:
         return _inner_ball;
     }
 
+    // set an inscribed ball, e.g. a previously computed one, that ComputeInnerBall() returns
     void set_InnerBall(std::pair<Point,NT> const& innerball) //const
     {
         _inner_ball = innerball;
+        _inner_ball_known = innerball.second > 0.0;
     }
 
     // return the number of generators
@@ -308,6 +323,8 @@ public:
     void set_mat(MT const& V2)
     {
         V = V2;
+        _inner_ball_known = false;
+        ray_lp.clear();
     }
 
     // change the vector b
@@ -358,24 +375,34 @@ public:
     }
 
 
-    // Compute an inner ball of the zonotope
+    // Compute an inner ball of the zonotope, i.e. the minimum r s.t. r e_i is in
+    // the zonotope for all i = 1,...,d; the ray shootings run in parallel
+    // the ball is computed once, unless the zonotope changes
     std::pair<Point,NT> ComputeInnerBall()
     {
-        std::vector<NT> temp(_d,0);
+        if (_inner_ball_known) return _inner_ball;
+
         NT radius =  maxNT, min_plus;
         Point center(_d);
 
+        std::vector<NT> min_plus_per_ray(_d);
+        #pragma omp parallel for
+        for (int i = 0; i < int(_d); ++i) {
+            std::vector<REAL> conv_comb_ray(V.rows() + 1), row_ray(V.rows() + 1);
+            std::vector<int> colno_ray(V.rows() + 1);
+            Point v(_d);
+            v.set_coord(i, 1.0);
+            min_plus_per_ray[i] = intersect_line_Vpoly<NT>(V, center, v, conv_comb_ray.data(),
+                                                           row_ray.data(), colno_ray.data(),
+                                                           false, true);
+        }
         for (unsigned int i = 0; i < _d; ++i) {
-            temp.assign(_d,0);
-            temp[i] = 1.0;
-            Point v(_d,temp.begin(), temp.end());
-            min_plus = intersect_line_Vpoly<NT>(V, center, v, conv_comb,
-                                                row, colno, false, true);
+            min_plus = min_plus_per_ray[i];
             if (min_plus < radius) radius = min_plus;
         }
 
         radius = radius / std::sqrt(NT(_d));
-        _inner_ball = std::pair<Point, NT> (center, radius);
+        set_InnerBall(std::pair<Point, NT> (center, radius));
         return _inner_ball;
     }
 
@@ -383,7 +410,7 @@ public:
     // with the Zonotope
     std::pair<NT,NT> line_intersect(Point const& r, Point const& v) const
     {
-        return intersect_line_zono(V, r, v, conv_comb, colno);
+        return ray_lp.intersect_line(V, r, v);
     }
 
 
@@ -394,7 +421,7 @@ public:
                                     VT const& Ar,
                                     VT const& Av) const
     {
-        return intersect_line_zono(V, r, v, conv_comb, colno);
+        return ray_lp.intersect_line(V, r, v);
     }
 
     // compute intersection point of ray starting from r and pointing to v
@@ -405,7 +432,7 @@ public:
                                     VT const& Av,
                                     NT const& lambda_prev) const
     {
-        return intersect_line_zono(V, r, v, conv_comb, colno);
+        return ray_lp.intersect_line(V, r, v);
     }
 
     std::pair<NT, int> line_positive_intersect(Point const& r,
@@ -413,9 +440,7 @@ public:
                                                VT const& Ar,
                                                VT const& Av) const
     {
-        return std::pair<NT, int> (intersect_line_Vpoly(V, r, v, conv_comb,
-                                                        row, colno,
-                                                        false, true), 1);
+        return std::pair<NT, int> (ray_lp.positive_intersect(V, r, v, conv_comb), 1);
     }
 
 
@@ -474,7 +499,7 @@ public:
         temp[rand_coord]=1.0;
         Point v(_d,temp.begin(), temp.end());
 
-        return intersect_line_zono(V, r, v, conv_comb, colno);
+        return ray_lp.intersect_line(V, r, v);
 
     }
 
@@ -548,6 +573,8 @@ public:
     {
         MT V2 = T.inverse() * V.transpose();
         V = V2.transpose();
+        _inner_ball_known = false;
+        ray_lp.clear();
     }
 
     // return false to the rounding function
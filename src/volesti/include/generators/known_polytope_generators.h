@@ -9,9 +9,33 @@
 #define KNOWN_POLYTOPE_GENERATORS_H
 
 #include <exception>
+#include <type_traits>
+#include <vector>
 
 #include "convex_bodies/hpolytope.h"
 #include "convex_bodies/vpolytope.h"
+#include "convex_bodies/crosspolytope.h"
+
+
+/// This function builds the matrix of a polytope from the list of its nonzero entries
+/// When MT is a sparse matrix type the dense matrix is never allocated
+/// @tparam MT Type of the returned matrix (dense or sparse)
+template <typename MT, typename NT>
+MT matrix_from_triplets(unsigned int const& rows, unsigned int const& cols,
+                        std::vector<Eigen::Triplet<NT>> const& entries)
+{
+    if constexpr (std::is_base_of<Eigen::SparseMatrixBase<MT>, MT>::value) {
+        MT A(rows, cols);
+        A.setFromTriplets(entries.begin(), entries.end());
+        return A;
+    } else {
+        MT A = MT::Zero(rows, cols);
+        for (auto const& entry : entries) {
+            A(entry.row(), entry.col()) = entry.value();
+        }
+        return A;
+    }
+}
 
 /// This function generates a hypercube of given dimension
 /// The result can be either in V-representation (Vpoly=true) or in H-representation (V-poly-false)
@@ -79,6 +103,7 @@ Polytope generate_cube(const unsigned int& dim, const bool& Vpoly,typename Polyt
 
 /// This function generates a crosspolytope of given dimension
 /// The result can be either in V-representation (Vpoly=true) or in H-representation (V-poly-false)
+/// The H-representation has 2^dim dense rows, see generate_implicit_cross
 /// @tparam Polytope Type of returned polytope
 template <typename Polytope>
 Polytope generate_cross(const unsigned int &dim, const bool &Vpoly) {
@@ -140,6 +165,16 @@ Polytope generate_cross(const unsigned int &dim, const bool &Vpoly) {
 }
 
 
+/// This function generates the crosspolytope of given dimension by its oracles,
+/// its 2^dim facets are never stored
+/// @tparam Point Point type of the returned CrossPolytope
+template <typename Point>
+CrossPolytope<Point> generate_implicit_cross(const unsigned int &dim) {
+
+    return CrossPolytope<Point>(dim);
+}
+
+
 /// This function generates a simplex of given dimension
 /// The result can be either in V-representation (Vpoly=true) or in H-representation (V-poly-false)
 /// @tparam Polytope Type of returned polytope
@@ -182,6 +217,7 @@ Polytope generate_simplex(const unsigned int &dim, const bool &Vpoly){
 
 /// This function generates a product of simplices of given dimension
 /// The result can be either in V-representation (Vpoly=true) or in H-representation (V-poly-false)
+/// The H-polytope can be defined by a sparse matrix, e.g. HPolytope<Point, Eigen::SparseMatrix<NT>>
 /// @tparam Polytope Type of returned polytope
 template <typename Polytope>
 Polytope generate_prod_simplex(const unsigned int &dim, bool Vpoly = false){
@@ -198,60 +234,34 @@ Polytope generate_prod_simplex(const unsigned int &dim, bool Vpoly = false){
         return Perr;
     }
 
-    typedef typename Eigen::Matrix<typename Polytope::NT, Eigen::Dynamic, Eigen::Dynamic>    MT;
+    typedef typename Polytope::NT    NT;
+    typedef typename Polytope::MT    MT;
     typedef typename Polytope::VT    VT;
 
-    MT A;
-    VT b;
-    A.resize(2 * dim + 2, 2 * dim);
-    b.resize(2 * dim + 2);
-
+    std::vector<Eigen::Triplet<NT>> entries;
+    entries.reserve(4 * dim);
+    VT b = VT::Zero(2 * dim + 2);
 
     //first simplex
     for(unsigned int i=0; i<dim; ++i){
-        b(i) = 0.0;
-        for(unsigned int j=0; j<dim; ++j) {
-            A(i, j) = 0.0;
-        }
-        for(unsigned int j=0; j<dim; ++j){
-            if(i==j) {
-                A(i, j + dim) = 1.0;
-            }else{
-                A(i, j + dim) = 0.0;
-            }
-        }
+        entries.emplace_back(i, i + dim, 1.0);
     }
-
     b(dim) = 1.0;
-    for(unsigned int j=0; j<dim; ++j) {
-        A(dim, j) = 0.0;
-    }
     for(unsigned int j=0; j<dim; ++j){
-        A(dim, j + dim) = -1.0;
+        entries.emplace_back(dim, j + dim, -1.0);
     }
 
     //second simplex
     for(unsigned int i=0; i<dim; ++i){
-        b(dim + 1 + i) = 0.0;
-        for(unsigned int j=0; j<dim; ++j){
-            if(i==j) {
-                A(dim + 1 + i, j) = 1.0;
-            }else {
-                A(dim + 1 + i, j) = 0.0;
-            }
-        }
-        for(unsigned int j=0; j<dim; ++j) {
-            A(dim + 1 + i, j + dim) = 0.0;
-        }
+        entries.emplace_back(dim + 1 + i, i, 1.0);
     }
     b(2 * dim +1) = 1.0;
     for(unsigned int j=0; j<dim; ++j) {
-        A(2 * dim +1, j) = -1.0;
-    }
-    for(unsigned int j=0; j<dim; ++j) {
-        A(2 * dim +1, j + dim) = 0.0;
+        entries.emplace_back(2 * dim + 1, j, -1.0);
     }
 
+    MT A = matrix_from_triplets<MT>(2 * dim + 2, 2 * dim, entries);
+
     return Polytope(2 * dim, A, b);
 }
 
@@ -315,6 +325,8 @@ Polytope generate_skinny_cube(const unsigned int &dim, bool Vpoly = false) {
 
 /// This function generates the Birkhoff polytope of given type n
 /// The Birkhoff polytope also called the assignment polytope or the polytope of doubly stochastic matrices.
+/// Its n^2 x (n-1)^2 matrix has only 4(n-1)^2 nonzero entries, thus it can be defined by a sparse matrix,
+/// e.g. HPolytope<Point, Eigen::SparseMatrix<NT>>
 /// @tparam Polytope Type of returned polytope
 template <typename Polytope>
 Polytope generate_birkhoff(unsigned int const& n) {
@@ -322,37 +334,41 @@ Polytope generate_birkhoff(unsigned int const& n) {
     unsigned int m = n * n;
     unsigned int d = n * n - 2 * n + 1;
 
-    typedef typename Eigen::Matrix<typename Polytope::NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+    typedef typename Polytope::NT NT;
+    typedef typename Polytope::MT MT;
     typedef typename Polytope::VT VT;
 
-    MT A = MT::Zero(m, d);
+    std::vector<Eigen::Triplet<NT>> entries;
+    entries.reserve(4 * d);
     VT b(m);
 
     b(d) = -1.0 * int(n - 2);
 
     for (int i = 0; i < d; ++i) {
-        A(d, i) = -1;
+        entries.emplace_back(d, i, -1.0);
     }
 
     for (int i = 0; i < d; ++i) {
         b(i) = 0;
-        A(i, i) = -1;
+        entries.emplace_back(i, i, -1.0);
     }
 
     for (int i = d+1; i < d+1+n-1; ++i) {
         b(i) = 1;
         for (int counter = 0; counter < n-1; ++counter) {
-            A(i, counter * (n-1) + (i-d-1)) = 1;
+            entries.emplace_back(i, counter * (n-1) + (i-d-1), 1.0);
         }
     }
 
     for (int i = d+n; i < m; ++i) {
         b(i) = 1;
         for (int counter = 0; counter < n-1; ++counter) {
-            A(i, counter + (i-d-n) * (n-1)) = 1;
+            entries.emplace_back(i, counter + (i-d-n) * (n-1), 1.0);
         }
     }
 
+    MT A = matrix_from_triplets<MT>(m, d, entries);
+
     Polytope P(d, A, b);
 
     return P;
@@ -23,6 +23,7 @@
 
 #include <stdio.h>
 #include <cmath>
+#include <vector>
 #include <exception>
 #undef Realloc
 #undef Free
@@ -163,6 +164,52 @@ bool memLP_Vpoly(const MT &V, const Point &q, NT *row, int *colno){
 }
 
 
+// return true if q is a convex combination of the vertices of the V-polytope described
+// by matrix V, i.e. if the LP  sum_i l_i V_i = q, sum_i l_i = 1, l >= 0  is feasible
+// otherwise return false
+// the vertices with a positive weight in the basic solution, at most d+1 of them, span
+// a simplex that contains q and they are stored in support
+// row and colno have to hold V.rows() elements
+template <typename MT, typename Point, typename NT>
+bool memLP_Vpoly_support(const MT &V, const Point &q, NT *row, int *colno,
+                         std::vector<int> &support){
+
+    int d = q.dimension(), m = V.rows(), i, j;
+    lprec *lp = make_lp(0, m);
+    if (lp == NULL) return false;
+
+    set_add_rowmode(lp, TRUE);
+    for (j = 0; j < m; ++j) colno[j] = j + 1;
+    for (i = 0; i < d; ++i) {
+        for (j = 0; j < m; ++j) row[j] = V(j, i);
+        if (!add_constraintex(lp, m, row, colno, EQ, q[i])) {
+            delete_lp(lp);
+            return false;
+        }
+    }
+    for (j = 0; j < m; ++j) row[j] = 1.0;
+    if (!add_constraintex(lp, m, row, colno, EQ, 1.0)) {
+        delete_lp(lp);
+        return false;
+    }
+    set_add_rowmode(lp, FALSE);
+
+    // the weights keep the default bounds [0, inf) and the objective is zero
+    set_verbose(lp, NEUTRAL);
+    bool feasible = solve(lp) == OPTIMAL;
+
+    support.clear();
+    REAL *weights;
+    if (feasible && get_ptr_variables(lp, &weights)) {
+        for (j = 0; j < m; ++j) {
+            if (weights[j] > 0.0) support.push_back(j);
+        }
+    }
+    delete_lp(lp);
+    return feasible;
+}
+
+
 
 // compute the intersection of a ray with a V-polytope
 // if maxi is true compute positive lambda, when the ray is p + lambda \cdot v
@@ -424,4 +471,146 @@ std::pair<NT,NT> intersect_double_line_Vpoly(const MT &V, const Point &p, const
 }
 
 
+// A persistent linear program for the ray-shooting oracles of a polytope that is the
+// image of a box of coefficients, i.e. for intersect_double_line_Vpoly of a V-polytope,
+// with coefficients in [0,1] that sum to 1, and for intersect_line_zono of a zonotope,
+// with coefficients in [-1,1]. The model is built once for the matrix V; for every
+// query only the right-hand side (the point p) and the column of the ray parameter
+// (the direction v) are updated, so lp_solve does not construct a new model and starts
+// from the basis of the previous query.
+// Copies do not share the model, each copy builds its own on its first query.
+template <typename NT>
+class RayShootingLP {
+    lprec *lp;
+    std::vector<REAL> column;
+    std::vector<int> rowno;
+    REAL lower, upper;   // the bounds of the coefficients
+    bool convex;         // add the row sum(coefficients) = 1
+
+    template <typename MT>
+    bool build(const MT &V)
+    {
+        int d = V.cols(), m = V.rows(), i, j;
+        int rows = convex ? d + 1 : d;
+        std::vector<REAL> row(m + 1);
+        std::vector<int> colno(m + 1);
+
+        lp = make_lp(0, m + 1);
+        if (lp == NULL) return false;
+
+        REAL infinite = get_infinite(lp); /* will return 1.0e30 */
+
+        set_add_rowmode(lp, TRUE);  /* makes building the model faster if it is done rows by row */
+        for (i = 0; i < rows; i++) {
+            for (j = 0; j < m; j++) {
+                colno[j] = j + 1; /* j_th column */
+                row[j] = (i < d) ? V(j, i) : 1.0;
+            }
+            colno[m] = m + 1; /* last column */
+            row[m] = 0.0;
+            if (!add_constraintex(lp, m + 1, row.data(), colno.data(), EQ, (i < d) ? 0.0 : 1.0)) {
+                clear();
+                return false;
+            }
+        }
+        set_add_rowmode(lp, FALSE); /* rowmode should be turned off again when done building the model */
+
+        for (j = 0; j < m; j++) {
+            set_bounds(lp, j + 1, lower, upper);
+        }
+        set_bounds(lp, m + 1, -infinite, infinite);
+
+        colno[0] = m + 1;
+        row[0] = 1.0;
+        if (!set_obj_fnex(lp, 1, row.data(), colno.data())) {
+            clear();
+            return false;
+        }
+        set_verbose(lp, NEUTRAL);
+
+        // the column of the ray parameter: objective coefficient and the d equality rows
+        column.resize(d + 1);
+        rowno.resize(d + 1);
+        for (i = 0; i <= d; i++) rowno[i] = i;
+        column[0] = 1.0;
+        return true;
+    }
+
+    template <typename MT, typename Point>
+    bool set_ray(const MT &V, const Point &p, const Point &v)
+    {
+        if (lp == NULL && !build(V)) return false;
+
+        int d = v.dimension();
+        for (int i = 0; i < d; i++) {
+            column[i + 1] = v[i];
+            set_rh(lp, i + 1, p[i]);
+        }
+        set_columnex(lp, V.rows() + 1, d + 1, column.data(), rowno.data());
+        return true;
+    }
+
+public:
+    RayShootingLP(REAL lower_bound, REAL upper_bound, bool convexity_row)
+        : lp(NULL), lower(lower_bound), upper(upper_bound), convex(convexity_row) {}
+
+    RayShootingLP(const RayShootingLP &other)
+        : lp(NULL), lower(other.lower), upper(other.upper), convex(other.convex) {}
+
+    RayShootingLP& operator=(const RayShootingLP &other)
+    {
+        if (this != &other) {
+            clear();
+            lower = other.lower;
+            upper = other.upper;
+            convex = other.convex;
+        }
+        return *this;
+    }
+
+    ~RayShootingLP()
+    {
+        clear();
+    }
+
+    // delete the model, e.g. when the polytope changes
+    void clear()
+    {
+        if (lp != NULL) delete_lp(lp);
+        lp = NULL;
+    }
+
+    // same output as intersect_double_line_Vpoly and intersect_line_zono
+    template <typename MT, typename Point>
+    std::pair<NT,NT> intersect_line(const MT &V, const Point &p, const Point &v)
+    {
+        std::pair<NT,NT> res_pair;
+        if (!set_ray(V, p, v)) return res_pair;
+
+        set_maxim(lp);
+        solve(lp);
+        res_pair.second = NT(-get_objective(lp));
+
+        set_minim(lp);
+        solve(lp);
+        res_pair.first = NT(-get_objective(lp));
+
+        return res_pair;
+    }
+
+    // same output as intersect_line_Vpoly with maxi = false;
+    // conv_comb gets the coefficients of the columns of V at the boundary point
+    template <typename MT, typename Point>
+    NT positive_intersect(const MT &V, const Point &p, const Point &v, NT *conv_comb)
+    {
+        if (!set_ray(V, p, v)) return -1.0;
+
+        set_minim(lp);
+        if (solve(lp) != OPTIMAL) return -1.0;
+
+        get_variables(lp, conv_comb);
+        return NT(-get_objective(lp));
+    }
+};
+
 #endif
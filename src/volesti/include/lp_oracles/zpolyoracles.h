@@ -24,6 +24,7 @@
 #include <stdio.h>
 #include <cmath>
 #include <exception>
+#include <vector>
 #undef Realloc
 #undef Free
 #include "lp_lib.h"
@@ -0,0 +1,201 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2024 Vissarion Fisikopoulos
+// Copyright (c) 2018-2024 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+#ifndef BINARY_CACHE_UTILS_HPP
+#define BINARY_CACHE_UTILS_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <Eigen/Eigen>
+
+// The keys, the binary i/o and the file handling of the files that volesti keeps
+// between runs, i.e. the annealing schedules, the checkpoints of the volume
+// algorithms and the preprocessed crhmc problems
+
+
+/// 64-bit FNV-1a hash of the data that defines a cached or checkpointed computation,
+/// e.g. a body and the parameters of its annealing schedule or of its preprocessing
+class fnv1a_hasher
+{
+    std::uint64_t _h = 14695981039346656037ULL;
+
+    // the intersection of two V-polytopes returns only the first one in get_mat()
+    template <typename Polytope>
+    auto add_second_body(Polytope const& P, int) -> decltype(P.get_mat2(), void())
+    {
+        add(P.get_mat2());
+    }
+
+    template <typename Polytope>
+    void add_second_body(Polytope const&, long) {}
+
+public:
+    void add_bytes(const void* data, std::size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            _h ^= bytes[i];
+            _h *= 1099511628211ULL;
+        }
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value>::type add(T const& value)
+    {
+        add_bytes(&value, sizeof(T));
+    }
+
+    void add(std::string const& str)
+    {
+        add(str.size());
+        add_bytes(str.data(), str.size());
+    }
+
+    template <typename Derived>
+    void add(Eigen::MatrixBase<Derived> const& M)
+    {
+        add(std::int64_t(M.rows()));
+        add(std::int64_t(M.cols()));
+        for (Eigen::Index j = 0; j < M.cols(); ++j) {
+            for (Eigen::Index i = 0; i < M.rows(); ++i) add(M(i, j));
+        }
+    }
+
+    template <typename Scalar, int Options, typename StorageIndex>
+    void add(Eigen::SparseMatrix<Scalar, Options, StorageIndex> const& M)
+    {
+        typedef Eigen::SparseMatrix<Scalar, Options, StorageIndex> SparseMT;
+        add(std::int64_t(M.rows()));
+        add(std::int64_t(M.cols()));
+        for (Eigen::Index k = 0; k < M.outerSize(); ++k) {
+            for (typename SparseMT::InnerIterator it(M, k); it; ++it) {
+                add(std::int64_t(it.row()));
+                add(std::int64_t(it.col()));
+                add(it.value());
+            }
+        }
+    }
+
+    template <typename Polytope>
+    void add_polytope(Polytope const& P)
+    {
+        add(P.get_mat());
+        add(P.get_vec());
+        add_second_body(P, 0);
+    }
+
+    std::uint64_t value() const
+    {
+        return _h;
+    }
+};
+
+
+// the hash of a body alone, e.g. to resume a checkpoint only on the body that wrote it
+template <typename Polytope>
+std::uint64_t polytope_fingerprint(Polytope const& P)
+{
+    fnv1a_hasher hasher;
+    hasher.add_polytope(P);
+    return hasher.value();
+}
+
+
+// binary i/o of a vector, its size is written first
+template <typename T>
+void write_binary_vector(std::ostream &os, std::vector<T> const& v)
+{
+    std::uint64_t size = v.size();
+    os.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    if (size > 0) os.write(reinterpret_cast<const char*>(v.data()), size * sizeof(T));
+}
+
+// return false if the stream ends before the vector
+template <typename T>
+bool read_binary_vector(std::istream &is, std::vector<T> &v)
+{
+    std::uint64_t size = 0;
+    is.read(reinterpret_cast<char*>(&size), sizeof(size));
+    if (!is || size > std::numeric_limits<std::uint32_t>::max()) return false;
+    v.resize(size);
+    if (size > 0) is.read(reinterpret_cast<char*>(v.data()), size * sizeof(T));
+    return bool(is);
+}
+
+// move the file tmp to file; rename does not replace an existing file on every platform
+inline bool replace_file(std::string const& tmp, std::string const& file)
+{
+    if (std::rename(tmp.c_str(), file.c_str()) == 0) return true;
+    std::remove(file.c_str());
+    return std::rename(tmp.c_str(), file.c_str()) == 0;
+}
+
+
+// A file of a cache directory is named by its key and starts with a magic string
+// of 8 characters, the size of the number type and the key
+
+inline std::string binary_cache_path(std::string const& directory, std::uint64_t const& key,
+                                     std::string const& extension)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.", (unsigned long long)(key));
+    return directory + "/" + name + extension;
+}
+
+template <typename NT>
+void write_binary_cache_header(std::ostream &os, const char (&magic)[8], std::uint64_t const& key)
+{
+    std::uint64_t nt_size = sizeof(NT);
+    os.write(magic, sizeof(magic));
+    os.write(reinterpret_cast<const char*>(&nt_size), sizeof(nt_size));
+    os.write(reinterpret_cast<const char*>(&key), sizeof(key));
+}
+
+// return false if the header was written for another cache, number type or key
+template <typename NT>
+bool read_binary_cache_header(std::istream &is, const char (&magic)[8], std::uint64_t const& key)
+{
+    char header[8];
+    std::uint64_t stored_key = 0, nt_size = 0;
+    is.read(header, sizeof(header));
+    is.read(reinterpret_cast<char*>(&nt_size), sizeof(nt_size));
+    is.read(reinterpret_cast<char*>(&stored_key), sizeof(stored_key));
+    return is && std::memcmp(header, magic, sizeof(magic)) == 0
+           && nt_size == sizeof(NT) && stored_key == key;
+}
+
+// write the header and then write_content(os) to a temporary file that replaces file,
+// thus a reader never finds a partial file; a failed write only costs a recomputation
+// in a later run, so it is not reported
+template <typename NT, typename ContentWriter>
+void write_binary_cache_file(std::string const& file, const char (&magic)[8],
+                             std::uint64_t const& key, ContentWriter const& write_content)
+{
+    std::string tmp = file + ".tmp";
+    {
+        std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+        if (!os) return;
+        write_binary_cache_header<NT>(os, magic, key);
+        write_content(os);
+        if (!os) {
+            os.close();
+            std::remove(tmp.c_str());
+            return;
+        }
+    }
+    replace_file(tmp, file);
+}
+
+#endif // BINARY_CACHE_UTILS_HPP
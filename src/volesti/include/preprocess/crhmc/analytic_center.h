@@ -22,10 +22,6 @@
 #include <fstream>
 #include <iostream>
 #include <vector>
-#ifndef SIMD_LEN
-#define SIMD_LEN 0
-#endif
-const size_t chol_k2 = (SIMD_LEN == 0) ? 1 : SIMD_LEN;
 
 /*This function computes the analytic center of the polytope*/
 //And detects additional constraint that need to be added
@@ -61,6 +57,7 @@ std::tuple<VT, SpMat, VT> analytic_center(SpMat const &A, VT const &b, Polytope
 
   CholObj solver = CholObj(transform_format<SpMat,NT,int>(A));
   solver.accuracyThreshold = 0;
+  solver.numThreads = options.num_threads;
   for (int iter = 0; iter < options.ipmMaxIter; iter++)
   {
     std::pair<VT, VT> pair_analytic_oracle = f.analytic_center_oracle(x);
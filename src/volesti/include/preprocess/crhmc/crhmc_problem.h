@@ -21,6 +21,7 @@
 #include "convex_bodies/hpolytope.h"
 #include "preprocess/crhmc/analytic_center.h"
 #include "preprocess/crhmc/crhmc_input.h"
+#include "preprocess/crhmc/crhmc_problem_cache.h"
 #include "preprocess/crhmc/crhmc_utils.h"
 #include "preprocess/crhmc/lewis_center.h"
 #include "preprocess/crhmc/opts.h"
@@ -29,12 +30,9 @@
 #include <chrono>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <vector>
 
-#ifndef SIMD_LEN
-#define SIMD_LEN 0
-#endif
-const size_t chol_k = (SIMD_LEN == 0) ? 1 : SIMD_LEN;
 
 ///
 /// Crhmc sampling problem: With this the user can define a crhmc polytope sampling problem
@@ -51,10 +49,12 @@ public:
   using SpMat = Eigen::SparseMatrix<NT>;
   using PM = Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, int>;
   using IndexVector = Eigen::Matrix<int, Eigen::Dynamic, 1>;
-  using CholObj = PackedChol<chol_k, int>;
+  // the preprocessing factorizes one system at a time; the lanes of the
+  // sampler are set by its own simdLen
+  using CholObj = PackedChol<1, int>;
   using Triple = Eigen::Triplet<NT>;
   using Barrier = two_sided_barrier<Point>;
-  using Tx = FloatArray<double, chol_k>;
+  using Tx = FloatArray<double, 1>;
   using Opts = opts<NT>;
   using Diagonal_MT = Eigen::DiagonalMatrix<NT, Eigen::Dynamic>;
   using Func = typename Input::Func;
@@ -86,6 +86,11 @@ public:
 
   VT width; // width of the varibles
   int nP;//input dimension
+  // Factorization of A A^T by remove_dependent_rows, kept for the next
+  // remove_fixed_variables while it is valid for the reduced A; rows_idx are the
+  // rows of the factorization that are still in A
+  std::shared_ptr<CholObj> rows_solver;
+  std::vector<int> rows_idx;
 
   Func &func;     // function handle
   Grad &df;       // gradient handle
@@ -113,14 +118,34 @@ public:
   int remove_fixed_variables(const NT tol = 1e-12) {
     int m = Asp.rows();
     int n = Asp.cols();
-    VT d = estimate_width();
-    CholObj solver = CholObj(transform_format<SpMat,NT,int>(Asp));
-    solver.accuracyThreshold = 0;
     VT w = VT::Ones(n, 1);
-    solver.decompose((Tx *)w.data());
-    VT out_vector = VT(m, 1);
-    solver.solve((Tx *)b.data(), (Tx *)out_vector.data());
-    VT x = Asp.transpose() * out_vector;
+    VT x;
+    VT d;
+    if (rows_solver) {
+      // the removed rows had clipped pivots, thus the factorization of
+      // remove_dependent_rows is the one of the reduced A A^T
+      int m0 = rows_solver->A.m;
+      VT b0 = VT::Zero(m0, 1);
+      for (int i = 0; i < m; i++) {
+        b0(rows_idx[i]) = b(i);
+      }
+      VT out0 = VT(m0, 1);
+      rows_solver->solve((Tx *)b0.data(), (Tx *)out0.data());
+      VT out_vector = VT(m, 1);
+      copy_indicies(out_vector, out0, rows_idx);
+      x = Asp.transpose() * out_vector;
+      d = estimate_width(*rows_solver, w);
+      rows_solver.reset();
+    } else {
+      CholObj solver = CholObj(transform_format<SpMat,NT,int>(Asp));
+      solver.accuracyThreshold = 0;
+      solver.numThreads = options.num_threads;
+      solver.decompose((Tx *)w.data());
+      VT out_vector = VT(m, 1);
+      solver.solve((Tx *)b.data(), (Tx *)out_vector.data());
+      x = Asp.transpose() * out_vector;
+      d = estimate_width(solver, w);
+    }
 
     x = ((x.array()).abs() < tol).select(0., x);
     std::vector<Triple> freeIndices;
@@ -235,26 +260,32 @@ public:
       SpMat Ai(numBadCols, n + numBadCols);
       std::vector<Triple> newColumns;
       std::vector<Triple> newRows;
+      std::vector<std::vector<Triple>> splitColumns(numBadCols);
       b.conservativeResize(m + numBadCols, 1);
       lb.conservativeResize(n + numBadCols, 1);
       ub.conservativeResize(n + numBadCols, 1);
 
+      //the bad columns are split independently
+      #pragma omp parallel for num_threads(options.num_threads) if(options.num_threads > 1)
       for (int j = 0; j < numBadCols; j++) {
         int i = badCols[j];
         int k = 0;
         for (SpMat::InnerIterator it(Asp, i); it; ++it) {
           if (k >= colCounts[i] / 2) {
-            newColumns.push_back(Triple(it.row(), j, it.value()));
+            splitColumns[j].push_back(Triple(it.row(), j, it.value()));
             it.valueRef() = 0;
           }
           k++;
         }
-        newRows.push_back(Triple(j, i, 1));
-        newRows.push_back(Triple(j, j + n, -1));
         lb(n + j) = lb(i);
         ub(n + j) = ub(i);
         b(m + j) = 0;
       }
+      for (int j = 0; j < numBadCols; j++) {
+        newColumns.insert(newColumns.end(), splitColumns[j].begin(), splitColumns[j].end());
+        newRows.push_back(Triple(j, badCols[j], 1));
+        newRows.push_back(Triple(j, j + n, -1));
+      }
       Ai.setFromTriplets(newRows.begin(), newRows.end());
       Aj.setFromTriplets(newColumns.begin(), newColumns.end());
       Asp.prune(0, 0);
@@ -302,21 +333,30 @@ public:
     int n = Asp.cols();
     VT v = VT(m);
     VT w = VT::Ones(n, 1);
-    CholObj solver = CholObj(transform_format<SpMat,NT,int>(Asp));
-    solver.accuracyThreshold = 0;
-    solver.decompose((Tx *)w.data());
-    solver.diagL((Tx *)v.data());
+    rows_solver.reset(new CholObj(transform_format<SpMat,NT,int>(Asp)));
+    rows_solver->accuracyThreshold = 0;
+    rows_solver->numThreads = options.num_threads;
+    rows_solver->decompose((Tx *)w.data());
+    rows_solver->diagL((Tx *)v.data());
     std::vector<bool> indices(m, false);
     std::vector<int> idx;
     bool changed = false;
+    bool clipped = true;
     for (int i = 0; i < m; i++) {
       if ((v(i) > tolerance) && (v(i) < infinity)) {
         indices[i] = true;
         idx.push_back(i);
       }else{
         changed=true;
+        clipped = clipped && v(i) >= infinity;
       }
     }
+    // The factorization skips the rows whose pivot is clipped; a small pivot
+    // changes the rest of the factor and then it has to be computed again
+    rows_idx = idx;
+    if (!clipped) {
+      rows_solver.reset();
+    }
     if (!changed) {
       return 0;
     }
@@ -393,7 +433,13 @@ public:
     }
     CholObj solver = CholObj(transform_format<SpMat,NT,int>(Asp));
     solver.accuracyThreshold = 0;
+    solver.numThreads = options.num_threads;
     solver.decompose((Tx *)hess.data());
+    return estimate_width(solver, hess);
+  }
+  // The width from a solver already decomposed with the weights hess
+  VT estimate_width(CholObj &solver, VT const &hess) {
+    int n = Asp.cols();
     VT w_vector(n, 1);
     solver.leverageScoreComplement((Tx *)w_vector.data());
     w_vector = (w_vector.cwiseMax(0)).cwiseProduct(hess.cwiseInverse());
@@ -507,7 +553,10 @@ public:
       Asp.makeCompressed();
     }
 //Class constructor
-  crhmc_problem(Input const &input, Opts _options = Opts())
+// If a cache directory is given the preprocessed problem is read from there,
+// when a previous run has stored it, otherwise it is stored after preprocessing
+  crhmc_problem(Input const &input, Opts _options = Opts(),
+                std::string const &cache_directory = std::string())
       : options(_options), func(input.f), df(input.df), ddf(input.ddf),
         fZero(input.fZero), fHandle(input.fHandle), dfHandle(input.dfHandle),
         ddfHandle(input.ddfHandle) {
@@ -519,7 +568,120 @@ public:
 #endif
 
     make_format(input, input.Aeq);
+    if (cache_directory.empty()) {
+      PreproccessProblem();
+      return;
+    }
+    std::uint64_t key = preprocessing_key();
+    if (crhmc_problem_cache::find<NT>(cache_directory, key, *this)) {
+      return;
+    }
     PreproccessProblem();
+    if (!terminate) {
+      crhmc_problem_cache::store<NT>(cache_directory, key, *this);
+    }
+  }
+  // Hash of the problem before its preprocessing and of the options it uses
+  std::uint64_t preprocessing_key() const {
+    fnv1a_hasher h;
+    h.add(std::string(crhmc_problem_cache::magic, sizeof(crhmc_problem_cache::magic)));
+    h.add(Asp);
+    h.add(b);
+    h.add(lb);
+    h.add(ub);
+    h.add(nP);
+    h.add(fZero);
+    h.add(fHandle);
+    h.add(dfHandle);
+    h.add(ddfHandle);
+    h.add(options.maxNZ);
+    h.add(options.max_coord);
+    h.add(options.EnableReordering);
+    return h.value();
+  }
+  // Write the preprocessed problem: the sparse A and b after the reordering of
+  // its rows, the bounds of the barrier, the map (T, y) to the input variables,
+  // the Lewis center with its weights and the width of the variables. The key
+  // can not hash the density, which is given only by its oracles, so their
+  // values around the center identify it.
+  void save(std::ostream &os) const {
+    crhmc_problem_cache::write_sparse(os, Asp);
+    crhmc_problem_cache::write_vector(os, b);
+    crhmc_problem_cache::write_vector(os, barrier.lb);
+    crhmc_problem_cache::write_vector(os, barrier.ub);
+    crhmc_problem_cache::write_sparse(os, T);
+    crhmc_problem_cache::write_vector(os, y);
+    crhmc_problem_cache::write_vector(os, center);
+    crhmc_problem_cache::write_vector(os, w_center);
+    crhmc_problem_cache::write_vector(os, width);
+    crhmc_problem_cache::write_vector(os, density_fingerprint(T * center + y));
+  }
+  // Read a problem written by save; return false, without changing the problem,
+  // if the file is corrupted or it was written for another density
+  bool load(std::istream &is) {
+    SpMat A_, T_;
+    VT b_, lb_, ub_, y_, center_, w_center_, width_, fingerprint;
+    if (!crhmc_problem_cache::read_sparse(is, A_) || !crhmc_problem_cache::read_vector(is, b_) ||
+        !crhmc_problem_cache::read_vector(is, lb_) || !crhmc_problem_cache::read_vector(is, ub_) ||
+        !crhmc_problem_cache::read_sparse(is, T_) || !crhmc_problem_cache::read_vector(is, y_) ||
+        !crhmc_problem_cache::read_vector(is, center_) ||
+        !crhmc_problem_cache::read_vector(is, w_center_) ||
+        !crhmc_problem_cache::read_vector(is, width_) ||
+        !crhmc_problem_cache::read_vector(is, fingerprint)) {
+      return false;
+    }
+    const int n = A_.cols();
+    if (A_.rows() != b_.rows() || lb_.rows() != n || ub_.rows() != n || T_.rows() != nP ||
+        T_.cols() != n || y_.rows() != nP || center_.rows() != n ||
+        w_center_.rows() != n || width_.rows() != n) {
+      return false;
+    }
+    VT f_center = density_fingerprint(T_ * center_ + y_);
+    // a NaN value of the oracles never matches
+    if (f_center.rows() != fingerprint.rows() ||
+        !((f_center - fingerprint).norm() <= 1e-12 * (1.0 + fingerprint.norm()))) {
+      return false;
+    }
+    Asp = A_;
+    b = b_;
+    barrier.set_bound(lb_, ub_);
+    T = T_;
+    y = y_;
+    Tidx = std::vector<int>(T.rows());
+    updateT();
+    center = center_;
+    isempty_center = false;
+    w_center = w_center_;
+    width = width_;
+    return true;
+  }
+  // f, its gradient and the diagonal of its Hessian at the point z of the
+  // original variables and at two points around it, empty for the uniform
+  // distribution. The values at z alone do not separate two densities that
+  // differ only away from z.
+  VT density_fingerprint(VT const &z) const {
+    if (fZero) {
+      return VT::Zero(0, 1);
+    }
+    VT u = VT::Ones(nP, 1), v = VT::Ones(nP, 1);
+    for (int i = 1; i < nP; i += 2) {
+      v(i) = -1.0;
+    }
+    const VT points[3] = {z, z + 0.1 * u, z - 0.2 * v};
+    VT fp = VT::Zero(3 * (2 * nP + 1), 1);
+    for (int k = 0; k < 3; k++) {
+      const int offset = k * (2 * nP + 1);
+      if (fHandle) {
+        fp(offset) = func(Point(points[k]));
+      }
+      if (dfHandle) {
+        fp.segment(offset + 1, nP) = df(Point(points[k])).getCoefficients();
+      }
+      if (ddfHandle) {
+        fp.segment(offset + 1 + nP, nP) = ddf(Point(points[k])).getCoefficients();
+      }
+    }
+    return fp;
   }
   // Initialization funciton
   void PreproccessProblem() {
@@ -571,6 +733,7 @@ public:
     std::tie(std::ignore, hess) = lewis_center_oracle(center, w_center);
     CholObj solver = CholObj(transform_format<SpMat,NT,int>(Asp));
     solver.accuracyThreshold = 0;
+    solver.numThreads = options.num_threads;
     VT Hinv = hess.cwiseInverse();
     solver.decompose((Tx *)Hinv.data());
     VT out(equations(), 1);
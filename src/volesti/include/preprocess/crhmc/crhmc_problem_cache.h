@@ -0,0 +1,100 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2024 Vissarion Fisikopoulos
+// Copyright (c) 2018-2024 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+#ifndef CRHMC_PROBLEM_CACHE_H
+#define CRHMC_PROBLEM_CACHE_H
+
+#include "Eigen/Eigen"
+#include "misc/binary_cache_utils.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/// Binary files of preprocessed crhmc problems. A file is named by a hash of the
+/// problem before its preprocessing, i.e. of Ax=b, lb<=x<=ub after the
+/// inequalities are turned to equalities, and of the options that the
+/// preprocessing depends on. The file starts with a magic string, the size of the
+/// number type and the key; the matrices and vectors follow.
+namespace crhmc_problem_cache {
+
+constexpr char magic[8] = {'V', 'O', 'L', 'C', 'R', 'H', 'M', '1'};
+
+inline std::string path(std::string const &directory, std::uint64_t const &key) {
+  return binary_cache_path(directory, key, "crhmc");
+}
+
+template <typename VT>
+void write_vector(std::ostream &os, VT const &v) {
+  write_binary_vector(os, std::vector<typename VT::Scalar>(v.data(), v.data() + v.size()));
+}
+
+template <typename VT>
+bool read_vector(std::istream &is, VT &v) {
+  std::vector<typename VT::Scalar> data;
+  if (!read_binary_vector(is, data)) return false;
+  v = Eigen::Map<VT>(data.data(), data.size());
+  return true;
+}
+
+// the compressed column storage is written as it is
+template <typename SpMat>
+void write_sparse(std::ostream &os, SpMat const &A) {
+  typedef typename SpMat::StorageIndex Index;
+  SpMat C = A;
+  C.makeCompressed();
+  std::vector<std::int64_t> dims = {std::int64_t(C.rows()), std::int64_t(C.cols())};
+  write_binary_vector(os, dims);
+  write_binary_vector(os, std::vector<Index>(C.outerIndexPtr(), C.outerIndexPtr() + C.outerSize() + 1));
+  write_binary_vector(os, std::vector<Index>(C.innerIndexPtr(), C.innerIndexPtr() + C.nonZeros()));
+  write_binary_vector(os, std::vector<typename SpMat::Scalar>(C.valuePtr(), C.valuePtr() + C.nonZeros()));
+}
+
+template <typename SpMat>
+bool read_sparse(std::istream &is, SpMat &A) {
+  typedef typename SpMat::StorageIndex Index;
+  std::vector<std::int64_t> dims;
+  std::vector<Index> outer, inner;
+  std::vector<typename SpMat::Scalar> values;
+  if (!read_binary_vector(is, dims) || !read_binary_vector(is, outer) ||
+      !read_binary_vector(is, inner) || !read_binary_vector(is, values)) {
+    return false;
+  }
+  if (dims.size() != 2 || dims[0] < 0 || dims[1] < 0 || inner.size() != values.size() ||
+      outer.size() != std::size_t(SpMat::IsRowMajor ? dims[0] : dims[1]) + 1 ||
+      outer.front() != 0 || outer.back() != Index(values.size())) {
+    return false;
+  }
+  // the map below trusts the indices, a corrupted file must not send it out of bounds
+  const std::int64_t inner_size = SpMat::IsRowMajor ? dims[1] : dims[0];
+  for (std::size_t k = 1; k < outer.size(); ++k) {
+    if (outer[k] < outer[k - 1]) return false;
+  }
+  for (std::size_t k = 0; k < inner.size(); ++k) {
+    if (inner[k] < 0 || inner[k] >= inner_size) return false;
+  }
+  A = Eigen::Map<const SpMat>(dims[0], dims[1], values.size(), outer.data(),
+                              inner.data(), values.data());
+  return true;
+}
+
+template <typename NT, typename Problem>
+void store(std::string const &directory, std::uint64_t const &key, Problem const &problem) {
+  write_binary_cache_file<NT>(path(directory, key), magic, key,
+                              [&](std::ostream &os) { problem.save(os); });
+}
+
+template <typename NT, typename Problem>
+bool find(std::string const &directory, std::uint64_t const &key, Problem &problem) {
+  std::ifstream is(path(directory, key), std::ios::binary);
+  if (!is || !read_binary_cache_header<NT>(is, magic, key)) return false;
+  return problem.load(is);
+}
+
+} // namespace crhmc_problem_cache
+
+#endif
@@ -23,10 +23,6 @@
 #include <fstream>
 #include <iostream>
 #include <vector>
-#ifndef SIMD_LEN
-#define SIMD_LEN 0
-#endif
-const size_t chol_k3 = (SIMD_LEN == 0) ? 1 : SIMD_LEN;
 
 /*This function computes the Lewis center of the polytope*/
 //And detects additional constraint that need to be added
@@ -63,6 +59,7 @@ std::tuple<VT, SpMat, VT, VT> lewis_center(SpMat const &A, VT const &b, Polytope
   std::vector<int> idx;
 
   CholObj solver = CholObj(transform_format<SpMat,NT,int>(A));
+  solver.numThreads = options.num_threads;
   VT w = VT::Ones(n, 1);
   VT wp = w;
   for (int iter = 0; iter < options.ipmMaxIter; iter++)
@@ -39,6 +39,7 @@ public:
   /*PackedCS Solver Options*/
   Type solver_accuracy_threshold=1e-2;
   int simdLen=1;
+  int num_threads=1; // threads of the Cholesky factorizations of the presolve and the sampler
 
   /*Sampler options*/
   bool DynamicWeight = true; //Enable the use of dynamic weights for each variable when sampling
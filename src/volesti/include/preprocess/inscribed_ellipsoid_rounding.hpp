@@ -32,11 +32,84 @@ compute_inscribed_ellipsoid(Custom_MT A, VT b, VT const& x0,
         return barrier_center_ellipsoid_linear_ineq<MT, ellipsoid_type, NT>(A, b, x0);
     } else
     {
-        std::runtime_error("Unknown rounding method.");
+        throw std::runtime_error("Unknown rounding method.");
     }
     return {};
 }
 
+// One step of the rounding for a polytope with a sparse matrix A. The barrier
+// ellipsoids are kept sparse and the new matrix is computed from the sparse Cholesky
+// factorization P E P^T = L L^T, as A P^T L^{-T} = (L^{-1} P A^T)^T, i.e. by a
+// triangular solve with a sparse right-hand side. The transformation P^T L^{-T} maps
+// the ellipsoid to the unit ball as the Cholesky factor of E^{-1} does for dense A.
+template<typename MT, typename VT, int ellipsoid_type, typename Polytope, typename NT>
+inline static void
+inscribed_ellipsoid_rounding_step_sparse(Polytope &P, VT const& x0,
+                                         unsigned int const& maxiter,
+                                         NT const& tol, NT const& reg,
+                                         MT &T, VT &shift, NT &round_val,
+                                         NT &R, NT &r, bool &converged)
+{
+    typedef Eigen::SparseMatrix<NT> SparseMT;
+    const int d = P.dimension();
+    VT center;
+    SparseMT E;
+
+    // Compute the desired inscribed ellipsoid in P
+    if constexpr (ellipsoid_type == EllipsoidType::MAX_ELLIPSOID)
+    {
+        MT E_dense;
+        std::tie(E_dense, center, converged) =
+            compute_inscribed_ellipsoid<MT, ellipsoid_type>(P.get_mat(), P.get_vec(), x0, maxiter, tol, reg);
+        E = E_dense.sparseView();
+    } else
+    {
+        std::tie(E, center, converged) =
+            compute_inscribed_ellipsoid<SparseMT, ellipsoid_type>(P.get_mat(), P.get_vec(), x0, maxiter, tol, reg);
+    }
+
+    SparseMT I(d, d);
+    I.setIdentity();
+    E = SparseMT(E.transpose()) + E;
+    E = E / 2.0 + I * std::pow(10, -8.0); //normalize E
+
+    Eigen::SimplicialLLT<SparseMT> llt(E);
+    if (llt.info() != Eigen::Success) {
+        throw std::runtime_error("The Cholesky factorization of the ellipsoid failed.");
+    }
+
+    // Computing eigenvalues of E with Lanczos iterations on the sparse matrix
+    auto op = get_mat_prod_op<NT>(E);
+    auto eigs = get_eigs_solver<NT>(op, d);
+    eigs->init();
+    eigs->compute();
+    if (eigs->info() == Spectra::COMPUTATION_INFO::SUCCESSFUL) {
+        R = 1.0 / eigs->eigenvalues().coeff(1);
+        r = 1.0 / eigs->eigenvalues().coeff(0);
+    } else {
+        Eigen::SelfAdjointEigenSolver<MT> eigensolver{MT(E)};
+        if (eigensolver.info() == Eigen::ComputationInfo::Success) {
+            R = 1.0 / eigensolver.eigenvalues().coeff(0);
+            r = 1.0 / eigensolver.eigenvalues().template tail<1>().value();
+        } else {
+            throw std::runtime_error("Computations failed.");
+        }
+    }
+
+    // Shift polytope and apply the linear transformation on P
+    P.shift(center);
+    shift.noalias() += T * center;
+
+    MT Tt = llt.permutationP() * T.transpose();
+    llt.matrixL().solveInPlace(Tt);
+    T = Tt.transpose(); // T = T * P^T * L^{-T}
+    round_val /= llt.matrixL().nestedExpression().diagonal().prod();
+
+    SparseMT At = llt.permutationP() * SparseMT(P.get_mat().transpose());
+    llt.matrixL().solveInPlace(At);
+    P.set_mat(At.transpose());
+}
+
 template 
 <
     typename MT,
@@ -76,41 +149,50 @@ std::tuple<MT, VT, NT> inscribed_ellipsoid_rounding(Polytope &P,
 
     while (true)
     {
-        // Compute the desired inscribed ellipsoid in P
-        std::tie(E, center, converged) = 
-            compute_inscribed_ellipsoid<MT, ellipsoid_type>(P.get_mat(), P.get_vec(), x0, maxiter, tol, reg);
+        if constexpr (std::is_base_of<Eigen::SparseMatrixBase<typename Polytope::MT>,
+                                      typename Polytope::MT>::value)
+        {
+            inscribed_ellipsoid_rounding_step_sparse<MT, VT, ellipsoid_type>(P, x0, maxiter, tol, reg,
+                                                                             T, shift, round_val, R, r,
+                                                                             converged);
+        } else
+        {
+            // Compute the desired inscribed ellipsoid in P
+            std::tie(E, center, converged) = 
+                compute_inscribed_ellipsoid<MT, ellipsoid_type>(P.get_mat(), P.get_vec(), x0, maxiter, tol, reg);
         
-        E = (E + E.transpose()) / 2.0;
-        E += MT::Identity(d, d)*std::pow(10, -8.0); //normalize E
-
-        Eigen::LLT<MT> lltOfA(E.llt().solve(MT::Identity(E.cols(), E.cols()))); // compute the Cholesky decomposition of E^{-1}
-        L = lltOfA.matrixL();
-
-        // Computing eigenvalues of E
-        Spectra::DenseSymMatProd<NT> op(E);
-        // The value of ncv is chosen empirically
-        Spectra::SymEigsSolver<NT, Spectra::SELECT_EIGENVALUE::BOTH_ENDS, 
-                               Spectra::DenseSymMatProd<NT>> eigs(&op, 2, std::min(std::max(10, int(d)/5), int(d)));
-        eigs.init();
-        int nconv = eigs.compute();
-        if (eigs.info() == Spectra::COMPUTATION_INFO::SUCCESSFUL) {
-            R = 1.0 / eigs.eigenvalues().coeff(1);
-            r = 1.0 / eigs.eigenvalues().coeff(0);
-        } else {
-            Eigen::SelfAdjointEigenSolver<MT> eigensolver(E);
-            if (eigensolver.info() == Eigen::ComputationInfo::Success) {
-                R = 1.0 / eigensolver.eigenvalues().coeff(0);
-                r = 1.0 / eigensolver.eigenvalues().template tail<1>().value();
+            E = (E + E.transpose()) / 2.0;
+            E += MT::Identity(d, d)*std::pow(10, -8.0); //normalize E
+
+            Eigen::LLT<MT> lltOfA(E.llt().solve(MT::Identity(E.cols(), E.cols()))); // compute the Cholesky decomposition of E^{-1}
+            L = lltOfA.matrixL();
+
+            // Computing eigenvalues of E
+            Spectra::DenseSymMatProd<NT> op(E);
+            // The value of ncv is chosen empirically
+            Spectra::SymEigsSolver<NT, Spectra::SELECT_EIGENVALUE::BOTH_ENDS, 
+                                   Spectra::DenseSymMatProd<NT>> eigs(&op, 2, std::min(std::max(10, int(d)/5), int(d)));
+            eigs.init();
+            int nconv = eigs.compute();
+            if (eigs.info() == Spectra::COMPUTATION_INFO::SUCCESSFUL) {
+                R = 1.0 / eigs.eigenvalues().coeff(1);
+                r = 1.0 / eigs.eigenvalues().coeff(0);
             } else {
-                std::runtime_error("Computations failed.");
+                Eigen::SelfAdjointEigenSolver<MT> eigensolver(E);
+                if (eigensolver.info() == Eigen::ComputationInfo::Success) {
+                    R = 1.0 / eigensolver.eigenvalues().coeff(0);
+                    r = 1.0 / eigensolver.eigenvalues().template tail<1>().value();
+                } else {
+                    throw std::runtime_error("Computations failed.");
+                }
             }
+            // Shift polytope and apply the linear transformation on P
+            P.shift(center);
+            shift.noalias() += T * center;
+            T.applyOnTheRight(L); // T = T * L;
+            round_val *= L.transpose().determinant();
+            P.linear_transformIt(L);
         }
-        // Shift polytope and apply the linear transformation on P
-        P.shift(center);
-        shift.noalias() += T * center;
-        T.applyOnTheRight(L); // T = T * L;
-        round_val *= L.transpose().determinant();
-        P.linear_transformIt(L);
 
         reg = std::max(reg / 10.0, std::pow(10, -10.0));
         P.normalize();
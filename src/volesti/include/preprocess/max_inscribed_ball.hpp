@@ -59,9 +59,11 @@ void calcstep(MT const& A, MT const& A_trans, MT const& B,
     }
 }
 
-// Using MT as to deal with both dense and sparse matrices
+// Using MT as to deal with both dense and sparse matrices.
+// The iterations start from x0, e.g. the center of a previous ball, which does not
+// have to be feasible; the slack s = b - A x0 - t e is kept positive through t.
 template <typename MT, typename VT, typename NT>
-std::tuple<VT, NT, bool>  max_inscribed_ball(MT const& A, VT const& b, 
+std::tuple<VT, NT, bool>  max_inscribed_ball(MT const& A, VT const& b, VT const& x0,
                                              unsigned int maxiter, NT tol,
                                              const bool feasibility_only = false) 
 {
@@ -72,9 +74,10 @@ std::tuple<VT, NT, bool>  max_inscribed_ball(MT const& A, VT const& b,
     NT bnrm = b.norm();
     VT o_m = VT::Zero(m), o_n = VT::Zero(n), e_m = VT::Ones(m);
 
-    VT x = o_n, y = e_m / m;
-    NT t = b.minCoeff() - 1.0;
-    VT s = b - e_m * t;
+    VT x = x0, y = e_m / m;
+    VT s = b - A * x;
+    NT t = s.minCoeff() - 1.0;
+    s -= e_m * t;
 
     VT dx = o_n;
     VT dxc = dx, ds = o_m;
@@ -214,4 +217,12 @@ std::tuple<VT, NT, bool>  max_inscribed_ball(MT const& A, VT const& b,
     return result;
 }
 
+template <typename MT, typename VT, typename NT>
+std::tuple<VT, NT, bool>  max_inscribed_ball(MT const& A, VT const& b, 
+                                             unsigned int maxiter, NT tol,
+                                             const bool feasibility_only = false) 
+{
+    return max_inscribed_ball(A, b, VT(VT::Zero(A.cols())), maxiter, tol, feasibility_only);
+}
+
 #endif // MAX_INSCRIBED_BALL_HPP
@@ -35,6 +35,79 @@
             matrix E2^{-1} = E_transpose * E
 */
 
+/*
+    The Newton system of the method is G = YQ .* (YQ)^T + diag(d), with Q = A * E2^{-1} * A^T,
+    which is m x m. For a polytope with many facets G is never formed: the (i,j)-th entry of
+    YQ .* (YQ)^T is y_i y_j (x_i^T a_j)^2, where x_i = E2^{-1} a_i, so the i-th entry of the
+    product with a vector w is y_i x_i^T (A^T diag(y .* w) A) x_i. This takes O(m n^2)
+    operations and O(m n) memory, and the system is solved by the conjugate gradient method.
+*/
+
+// The dense path factorizes G in O(m^3) and needs three m x m matrices, the matrix-free
+// one costs O(m n^3) per conjugate gradient iteration; the latter is faster when m is
+// a few times n^2 and the only feasible one when the dense matrices do not fit in memory
+template <typename NT>
+bool mve_use_matrix_free(int const& m, int const& n)
+{
+    return m > 1000 && (NT(m) > NT(4) * NT(n) * NT(n) || m > 20000);
+}
+
+// G * W, where the rows of Xt are the vectors E2^{-1} a_i
+template <typename MT_dense, typename MT, typename VT>
+MT_dense mve_newton_product(MT const& A, MT const& A_trans, MT_dense const& Xt,
+                            VT const& y, VT const& d, MT_dense const& W)
+{
+    MT_dense GW(W.rows(), W.cols()), M;
+    for (int j = 0; j < W.cols(); ++j) {
+        M = MT_dense(A_trans * y.cwiseProduct(W.col(j)).asDiagonal() * A);
+        GW.col(j) = (Xt * M).cwiseProduct(Xt).rowwise().sum();
+    }
+    return y.asDiagonal() * GW + d.asDiagonal() * W;
+}
+
+// Solve G * X = B by the conjugate gradient method, one independent iteration per column
+// with a Jacobi preconditioner, starting from the current X, e.g. the solution of the
+// previous step of the interior point method
+template <typename MT_dense, typename MT, typename VT, typename NT>
+void mve_newton_solve(MT const& A, MT const& A_trans, MT_dense const& Xt, VT const& y,
+                      VT const& h, VT const& d, MT_dense const& B, MT_dense &X,
+                      NT const& tol, unsigned int const& maxiter)
+{
+    const int k = B.cols();
+    // the diagonal of G is y_i^2 Q_ii^2 + d_i and h_i^2 = Q_ii
+    VT const precond = (y.cwiseProduct(h.cwiseProduct(h))).cwiseAbs2() + d;
+    VT const precond_inv = precond.cwiseInverse();
+    VT const b_norm = B.colwise().norm().transpose();
+
+    MT_dense R = B - mve_newton_product(A, A_trans, Xt, y, d, X);
+    MT_dense Z = precond_inv.asDiagonal() * R;
+    MT_dense P = Z, GP;
+    VT rz = R.cwiseProduct(Z).colwise().sum().transpose(), rz_new(k), alpha(k), beta(k);
+
+    for (unsigned int it = 0; it < maxiter; ++it) {
+        bool converged = true;
+        for (int j = 0; j < k; ++j) {
+            if (R.col(j).norm() > tol * b_norm(j)) converged = false;
+        }
+        if (converged) break;
+
+        GP = mve_newton_product(A, A_trans, Xt, y, d, P);
+        VT pGp = P.cwiseProduct(GP).colwise().sum().transpose();
+        for (int j = 0; j < k; ++j) {
+            alpha(j) = (pGp(j) > NT(0)) ? rz(j) / pGp(j) : NT(0);
+        }
+        X.noalias() += P * alpha.asDiagonal();
+        R.noalias() -= GP * alpha.asDiagonal();
+        Z = precond_inv.asDiagonal() * R;
+        rz_new = R.cwiseProduct(Z).colwise().sum().transpose();
+        for (int j = 0; j < k; ++j) {
+            beta(j) = (rz(j) > NT(0)) ? rz_new(j) / rz(j) : NT(0);
+        }
+        P = Z + P * beta.asDiagonal();
+        rz = rz_new;
+    }
+}
+
 // Using MT as to deal with both dense and sparse matrices, MT_dense will be the type of result matrix
 template <typename MT_dense, typename MT, typename VT, typename NT>
 std::tuple<MT_dense, VT, bool> max_inscribed_ellipsoid(MT A, VT b, VT const& x0,
@@ -64,12 +137,24 @@ std::tuple<MT_dense, VT, bool> max_inscribed_ellipsoid(MT A, VT b, VT const& x0,
 
     VT const bmAx0 = b - A * x0, ones_m = VT::Ones(m);
 
-    MT_dense Q(m,m), YQ(m,m), G(m,m), T(m,n), ATP(n,m), ATP_A(n,n);
+    const bool matrix_free = mve_use_matrix_free<NT>(m, n);
+    const unsigned int cg_maxiter = 500;
+    const NT cg_tol = 1e-10;
+
+    MT_dense Q, YQ, G, T = MT_dense::Zero(m,n), ATP(n,m), ATP_A(n,n), Xt, dyDy_mat = MT_dense::Zero(m,1);
+    if (matrix_free) {
+        Xt.resize(m,n);
+    } else {
+        Q.resize(m,m);
+        YQ.resize(m,m);
+        G.resize(m,m);
+    }
     Diagonal_MT Y(m);
     MT YA(m, n);
 
     A = (ones_m.cwiseProduct(bmAx0.cwiseInverse())).asDiagonal() * A, b = ones_m;
     MT A_trans = A.transpose(), E2(n,n);
+    VT const ones_n = VT::Ones(n);
 
     auto llt = initialize_chol<NT>(A_trans, A);
 
@@ -79,9 +164,14 @@ std::tuple<MT_dense, VT, bool> max_inscribed_ellipsoid(MT A, VT b, VT const& x0,
         Y = y.asDiagonal();
 
         update_Atrans_Diag_A<NT>(E2, A_trans, A, Y);
-        Q.noalias() = A * solve_mat(llt, E2, A_trans, logdetE2);
-        
-        h = Q.diagonal();
+        if (matrix_free) {
+            // the leverage scores Q_ii = a_i^T E2^{-1} a_i
+            Xt = solve_mat(llt, E2, A_trans, logdetE2).transpose();
+            h = A.cwiseProduct(Xt) * ones_n;
+        } else {
+            Q.noalias() = A * solve_mat(llt, E2, A_trans, logdetE2);
+            h = Q.diagonal();
+        }
         h = h.cwiseSqrt();
 
         if (i == 1) {
@@ -98,7 +188,11 @@ std::tuple<MT_dense, VT, bool> max_inscribed_ellipsoid(MT A, VT b, VT const& x0,
                 vec_iter2++;
                 vec_iter3++;
             }
-            Q *= (t * t);
+            if (matrix_free) {
+                Xt *= (t * t);
+            } else {
+                Q *= (t * t);
+            }
             Y = Y * (1.0 / (t * t));
         }
 
@@ -169,8 +263,6 @@ std::tuple<MT_dense, VT, bool> max_inscribed_ellipsoid(MT A, VT b, VT const& x0,
         }
 
         prev_obj = objval; // storing the objective value of the previous iteration
-        YQ.noalias() = Y * Q;
-        G = YQ.cwiseProduct(YQ.transpose());
         y2h = 2.0 * yh;
         update_Diag_A<NT>(YA, Y, A); // YA = Y * A;
 
@@ -184,10 +276,18 @@ std::tuple<MT_dense, VT, bool> max_inscribed_ellipsoid(MT A, VT b, VT const& x0,
             vec_iter3++;
         }
 
-        G.diagonal() += y2h_z;
         h_z = h + z;
-        Eigen::PartialPivLU<MT_dense> luG(G);
-        T.noalias() = luG.solve(MT_dense(h_z.asDiagonal()*YA));
+        Eigen::PartialPivLU<MT_dense> luG;
+        if (matrix_free) {
+            mve_newton_solve(A, A_trans, Xt, y, h, y2h_z, MT_dense(h_z.asDiagonal()*YA), T,
+                             cg_tol, cg_maxiter);
+        } else {
+            YQ.noalias() = Y * Q;
+            G = YQ.cwiseProduct(YQ.transpose());
+            G.diagonal() += y2h_z;
+            luG.compute(G);
+            T.noalias() = luG.solve(MT_dense(h_z.asDiagonal()*YA));
+        }
 
         ATP.noalias() = MT_dense(y2h.asDiagonal()*T - YA).transpose();
 
@@ -203,12 +303,18 @@ std::tuple<MT_dense, VT, bool> max_inscribed_ellipsoid(MT A, VT b, VT const& x0,
 
         R23 = R2 - R3Dy;
         ATP_A.noalias() = ATP * A;
-        ATP_A.diagonal() += ones_m * reg;
+        ATP_A.diagonal() += ones_n * reg;
         dx = ATP_A.lu().solve(R1 + ATP * R23); // predictor step
 
         // corrector and combined step & length
         Adx.noalias() = A * dx;
-        dyDy = luG.solve(y2h.cwiseProduct(Adx-R23));
+        if (matrix_free) {
+            mve_newton_solve(A, A_trans, Xt, y, h, y2h_z, MT_dense(y2h.cwiseProduct(Adx-R23)),
+                             dyDy_mat, cg_tol, cg_maxiter);
+            dyDy = dyDy_mat.col(0);
+        } else {
+            dyDy = luG.solve(y2h.cwiseProduct(Adx-R23));
+        }
 
         dy = y.cwiseProduct(dyDy);
         dz = R3Dy - z.cwiseProduct(dyDy);
@@ -10,6 +10,8 @@
 #ifndef MIN_ELLIPSOID_ROUNDING_HPP
 #define MIN_ELLIPSOID_ROUNDING_HPP
 
+#include <list>
+#include <vector>
 #include <Eigen/Eigen>
 #include "minimum_ellipsoid/khach.h"
 #include "sampling/random_point_generators.hpp"
@@ -28,7 +30,8 @@ template
 std::tuple<MT, VT, NT> min_sampling_covering_ellipsoid_rounding(Polytope &P,
                                                                 std::pair<Point,NT> &InnerBall,
                                                                 const unsigned int &walk_length,
-                                                                RandomNumberGenerator &rng)
+                                                                RandomNumberGenerator &rng,
+                                                                unsigned int const& num_threads = 1)
 {
     typedef typename WalkTypePolicy::template Walk
             <
@@ -42,7 +45,6 @@ std::tuple<MT, VT, NT> min_sampling_covering_ellipsoid_rounding(Polytope &P,
     NT ratio = 10, round_val = 1.0;
     unsigned int iter = 0, j, i;
     const unsigned int num_of_samples = 10*d;//this is the number of sample points will used to compute min_ellipoid
-    PushBackWalkPolicy push_back_policy;
 
     MT T = MT::Identity(d,d);
     VT shift = VT::Zero(d);
@@ -55,12 +57,41 @@ std::tuple<MT, VT, NT> min_sampling_covering_ellipsoid_rounding(Polytope &P,
             // If P is not a V-Polytope or number_of_vertices>20*domension
             // 2. Generate the first random point in P
             // Perform random walk on random point in the Chebychev ball
-            Point c = InnerBall.first;
-            NT radius = InnerBall.second;
-            Point p = GetPointInDsphere<Point>::apply(d, radius, rng);
-            p += c;
-            RandomPointGenerator::apply(P, p, num_of_samples, walk_length,
-                                        randPoints, push_back_policy, rng);
+            // The samples are split over num_threads chains, every chain starts from
+            // its own point and uses its own generator seeded by rng
+            const unsigned int num_chains = std::max(1u, std::min(num_threads, num_of_samples / 2u));
+            std::vector<RandomNumberGenerator> rngs(num_chains > 1 ? num_chains : 0, rng);
+            for (unsigned int t = 0; t < rngs.size(); ++t)
+            {
+                rngs[t].set_seed((unsigned int)(rng.sample_urdist()
+                                 * NT(std::numeric_limits<unsigned int>::max())));
+            }
+            std::vector<std::list<Point>> chain_points(num_chains);
+
+            #pragma omp parallel for num_threads(num_chains) if(num_chains > 1)
+            for (int t = 0; t < int(num_chains); ++t)
+            {
+                RandomNumberGenerator &chain_rng = (num_chains > 1) ? rngs[t] : rng;
+                unsigned int chain_samples = num_of_samples / num_chains
+                                             + (unsigned(t) < num_of_samples % num_chains ? 1 : 0);
+                Point c = InnerBall.first;
+                NT radius = InnerBall.second;
+                Point p = GetPointInDsphere<Point>::apply(d, radius, chain_rng);
+                p += c;
+                PushBackWalkPolicy push_back_policy;
+                if (num_chains > 1) {
+                    Polytope Pt(P);
+                    RandomPointGenerator::apply(Pt, p, chain_samples, walk_length,
+                                                chain_points[t], push_back_policy, chain_rng);
+                } else {
+                    RandomPointGenerator::apply(P, p, chain_samples, walk_length,
+                                                chain_points[t], push_back_policy, chain_rng);
+                }
+            }
+            for (unsigned int t = 0; t < num_chains; ++t)
+            {
+                randPoints.splice(randPoints.end(), chain_points[t]);
+            }
         }
 
         // Store points in a matrix to call Khachiyan algorithm for the minimum volume enclosing ellipsoid
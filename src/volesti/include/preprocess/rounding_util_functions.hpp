@@ -12,6 +12,7 @@
 #define ROUNDING_UTIL_FUNCTIONS_HPP
 
 #include <memory>
+#include <vector>
 
 #include "Spectra/include/Spectra/SymEigsSolver.h"
 #include "Spectra/include/Spectra/MatOp/DenseSymMatProd.h"
@@ -134,6 +135,41 @@ solve_mat(std::unique_ptr<Eigen_lltMT> const& llt,
     }
 }
 
+// Computes the diagonal of A H^{-1} A^T, i.e. the values a_i^T H^{-1} a_i for the rows a_i of A.
+// For sparse matrices, P H P^T = L L^T gives a_i^T H^{-1} a_i = ||L^{-1} P a_i||^2, and
+// L^{-1} P A^T is computed by a triangular solve with a sparse right-hand side
+// instead of the dense H^{-1} A^T
+template <typename MT_dense, typename Eigen_lltMT, typename MT, typename NT>
+inline static Eigen::Matrix<NT, Eigen::Dynamic, 1>
+get_diag_A_Hinv_Atrans(std::unique_ptr<Eigen_lltMT> const& llt, MT const& H,
+                       MT const& A, MT const& A_trans, NT &logdetE)
+{
+    using DenseMT = Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic>;
+    using SparseMT = Eigen::SparseMatrix<NT>;
+    if constexpr (std::is_same<MT, DenseMT>::value)
+    {
+        MT_dense HA = solve_mat(llt, H, A_trans, logdetE);
+        MT_dense aiHai = HA.transpose().cwiseProduct(A);
+        return aiHai.rowwise().sum();
+    } else if constexpr (std::is_base_of<Eigen::SparseMatrixBase<MT>, MT >::value)
+    {
+        llt->factorize(H);
+        logdetE = llt->matrixL().nestedExpression().diagonal().array().log().sum();
+        SparseMT Z = llt->permutationP() * SparseMT(A_trans);
+        llt->matrixL().solveInPlace(Z);
+        Eigen::Matrix<NT, Eigen::Dynamic, 1> aiHai(Z.cols());
+        for (int k = 0; k < Z.outerSize(); k++)
+        {
+            aiHai.coeffRef(k) = Z.col(k).squaredNorm();
+        }
+        return aiHai;
+    } else
+    {
+        static_assert(AssertFalseType<MT>::value,
+            "Matrix type is not supported.");
+    }
+}
+
 template <typename NT, typename MT, typename diag_MT>
 inline static void update_Atrans_Diag_A(MT &H, MT const& A_trans,
                                         MT const& A, diag_MT const& D)
@@ -143,10 +179,56 @@ inline static void update_Atrans_Diag_A(MT &H, MT const& A_trans,
     if constexpr (std::is_same<MT, DenseMT>::value)
     {
         H.noalias() = A_trans * D * A;
-    } else if constexpr (std::is_base_of<Eigen::SparseMatrixBase<MT>, MT >::value)  
+    } else if constexpr (std::is_base_of<Eigen::SparseMatrixBase<MT>, MT >::value)
     {
-        H = A_trans * D * A;
-    } else 
+        if (MT::IsRowMajor || H.nonZeros() == 0 || !H.isCompressed())
+        {
+            H = A_trans * D * A;
+            H.makeCompressed();
+            return;
+        }
+        // Only the values are updated, so the pattern of H has to contain the one of
+        // A^T D A. It does when H is an earlier A^T D' A of the same A, e.g. of the
+        // previous Newton iteration. Column j of H is accumulated in a dense vector
+        // and gathered in its pattern; a nonzero out of the pattern means that H was
+        // built otherwise, and then H is recomputed
+        auto const& d = D.diagonal();
+        Eigen::Matrix<NT, Eigen::Dynamic, 1> col = Eigen::Matrix<NT, Eigen::Dynamic, 1>::Zero(H.rows());
+        std::vector<int> last_col(H.rows(), -1), touched;
+        bool in_pattern = true;
+        for (int j = 0; j < A.outerSize() && in_pattern; j++)
+        {
+            touched.clear();
+            for (typename MT::InnerIterator itA(A, j); itA; ++itA)
+            {
+                const NT dkakj = d.coeff(itA.row()) * itA.value();
+                for (typename MT::InnerIterator itAt(A_trans, itA.row()); itAt; ++itAt)
+                {
+                    col.coeffRef(itAt.row()) += itAt.value() * dkakj;
+                    if (last_col[itAt.row()] != j)
+                    {
+                        last_col[itAt.row()] = j;
+                        touched.push_back(itAt.row());
+                    }
+                }
+            }
+            for (typename MT::InnerIterator itH(H, j); itH; ++itH)
+            {
+                itH.valueRef() = col.coeff(itH.row());
+                col.coeffRef(itH.row()) = NT(0);
+            }
+            for (int i : touched)
+            {
+                if (col.coeff(i) != NT(0)) in_pattern = false;
+                col.coeffRef(i) = NT(0);
+            }
+        }
+        if (!in_pattern)
+        {
+            H = A_trans * D * A;
+            H.makeCompressed();
+        }
+    } else
     {
         static_assert(AssertFalseType<MT>::value,
             "Matrix type is not supported.");
@@ -181,7 +263,22 @@ inline static void update_A_Diag(MT &H, MT const& A, diag_MT const& D)
         H.noalias() = A * D;
     } else if constexpr (std::is_base_of<Eigen::SparseMatrixBase<MT>, MT >::value)  
     {
-        H = A * D;
+        if (H.nonZeros() != A.nonZeros() || !H.isCompressed() || !A.isCompressed())
+        {
+            H = A * D;
+            H.makeCompressed();
+            return;
+        }
+        // H keeps the pattern of A, only the values are scaled
+        auto const& d = D.diagonal();
+        NT *h_values = H.valuePtr();
+        for (int k = 0; k < A.outerSize(); ++k)
+        {
+            for (typename MT::InnerIterator it(A, k); it; ++it, ++h_values)
+            {
+                *h_values = it.value() * d.coeff(it.col());
+            }
+        }
     } else 
     {
         static_assert(AssertFalseType<MT>::value,
@@ -301,37 +398,50 @@ update_Bmat(MT &B, VT const& AtDe, VT const& d,
         B.noalias() += 1e-14 * MT::Identity(n + 1, n + 1);
     } else if constexpr (std::is_base_of<Eigen::SparseMatrixBase<MT>, MT >::value)  
     {
-        MT AtD_A = AtD * A;
-        int k = 0;
-        while(k < B.outerSize())
+        if (MT::IsRowMajor)
         {
-            typename MT::InnerIterator it2(AtD_A, k <= n-1 ? k : k-1);
-            for (typename MT::InnerIterator it1(B, k); it1; ++it1)
-            {                
-                if (it1.row() <= n-1 && it1.col() <= n-1)
-                {
-                    it1.valueRef() = it2.value();
-                }
-                else if (it1.row() == n && it1.col() <= n-1)
+            MT AtD_A = AtD * A;
+            for (int k = 0; k < B.outerSize(); ++k)
+            {
+                for (typename MT::InnerIterator it(B, k); it; ++it)
                 {
-                    it1.valueRef() = AtDe.coeff(it1.col());
+                    if (it.row() < n && it.col() < n) it.valueRef() = AtD_A.coeff(it.row(), it.col());
+                    else if (it.row() < n) it.valueRef() = AtDe.coeff(it.row());
+                    else if (it.col() < n) it.valueRef() = AtDe.coeff(it.col());
+                    else it.valueRef() = d.sum();
+                    if (it.row() == it.col()) it.valueRef() += 1e-14;
                 }
-                else if (it1.col() == n && it1.row() <= n-1)
+            }
+            return;
+        }
+        // The pattern of B is fixed in init_Bmat, so AtD * A is not formed as a new
+        // sparse matrix; each column is accumulated in a dense vector and gathered
+        VT col = VT::Zero(n);
+        for (int j = 0; j < n; ++j)
+        {
+            for (typename MT::InnerIterator itA(A, j); itA; ++itA)
+            {
+                for (typename MT::InnerIterator itAtD(AtD, itA.row()); itAtD; ++itAtD)
                 {
-                    it1.valueRef() = AtDe.coeff(it1.row());
+                    col.coeffRef(itAtD.row()) += itAtD.value() * itA.value();
                 }
-                else // then, (it1.row() == n && it1.col() == n)
+            }
+            for (typename MT::InnerIterator it(B, j); it; ++it)
+            {
+                if (it.row() < n)
                 {
-                    it1.valueRef() = d.sum();
-                }
-
-                if (it1.row() == it1.col())
+                    it.valueRef() = col.coeff(it.row());
+                    col.coeffRef(it.row()) = NT(0);
+                } else
                 {
-                    it1.valueRef() += 1e-14;
+                    it.valueRef() = AtDe.coeff(j);
                 }
-                if (it1.row()<n-1) ++it2;
+                if (it.row() == j) it.valueRef() += 1e-14;
             }
-            k++;
+        }
+        for (typename MT::InnerIterator it(B, n); it; ++it)
+        {
+            it.valueRef() = (it.row() < n) ? AtDe.coeff(it.row()) : d.sum() + 1e-14;
         }
     } else 
     {
@@ -372,9 +482,7 @@ void get_barrier_hessian_grad(MT const& A, MT const& A_trans, VT const& b,
                 BarrierType == EllipsoidType::VAIDYA_BARRIER)
   {
     // Computing sigma(x)_i = (a_i^T H^{-1} a_i) / (b_i - a_i^Tx)^2
-    MT_dense HA = solve_mat(llt, H, A_trans, obj_val);
-    MT_dense aiHai = HA.transpose().cwiseProduct(A);
-    sigma = (aiHai.rowwise().sum()).cwiseProduct(s_sq);
+    sigma = get_diag_A_Hinv_Atrans<MT_dense>(llt, H, A, A_trans, obj_val).cwiseProduct(s_sq);
   }
 
   if constexpr (BarrierType == EllipsoidType::LOG_BARRIER)
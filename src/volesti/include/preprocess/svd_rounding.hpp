@@ -11,7 +11,23 @@
 #ifndef SVD_ROUNDING_HPP
 #define SVD_ROUNDING_HPP
 
-
+#include <list>
+#include <vector>
+#include <Eigen/Eigen>
+#include "sampling/random_point_generators.hpp"
+#include "volume/sampling_policies.hpp"
+
+
+// Draws num_rounding_steps points from P and computes the principal axes of the
+// sample, V, the ratios s of its standard deviations along them to the smallest
+// one and its mean. The points are split over num_threads chains, every chain
+// with its own random number generator seeded by rng, and each chain reduces its
+// points to their mean and scatter matrix, which are then merged. The axes are the
+// eigenvectors of the scatter matrix, i.e. the right singular vectors of the
+// centered sample, thus the sample matrix is never formed.
+// A chain draws only about N / num_threads points, so with more than one chain the
+// points close to p would weigh more in the sample; thus every chain first walks
+// min(d, its number of points) points from p that are not kept.
 template
 <
     typename WalkTypePolicy,
@@ -22,7 +38,8 @@ template
     typename RandomNumberGenerator
 >
 void svd_on_sample(Polytope &P, Point &p, unsigned int const& num_rounding_steps, MT &V, VT &s, VT &Means,
-                   unsigned int const& walk_length, RandomNumberGenerator &rng)
+                   unsigned int const& walk_length, RandomNumberGenerator &rng,
+                   unsigned int const& num_threads = 1)
 {
     typedef typename WalkTypePolicy::template Walk
             <
@@ -31,31 +48,75 @@ void svd_on_sample(Polytope &P, Point &p, unsigned int const& num_rounding_steps
             > walk;
 
     typedef RandomPointGenerator <walk> RandomPointGenerator;
-    PushBackWalkPolicy push_back_policy;
-
-    unsigned int N = num_rounding_steps;
+    typedef typename Point::FT NT;
 
-    std::list<Point> randPoints;
-    MT RetMat(N, P.dimension());
-    RandomPointGenerator::apply(P, p, N, walk_length, randPoints,
-                                push_back_policy, rng);
+    const unsigned int N = num_rounding_steps, d = P.dimension();
+    const unsigned int num_chains = std::max(1u, std::min(num_threads, N / 2u));
 
-    int jj = 0;
-    for (typename std::list<Point>::iterator rpit = randPoints.begin(); rpit!=randPoints.end(); rpit++, jj++)
+    // a single chain uses rng and P, otherwise every chain has its own generator
+    // seeded by rng, so the result depends only on the seed and num_threads
+    std::vector<RandomNumberGenerator> rngs(num_chains > 1 ? num_chains : 0, rng);
+    for (unsigned int t = 0; t < rngs.size(); ++t)
     {
-        RetMat.row(jj) = (*rpit).getCoefficients().transpose();
+        rngs[t].set_seed((unsigned int)(rng.sample_urdist()
+                         * NT(std::numeric_limits<unsigned int>::max())));
     }
 
-    for (int i = 0; i < P.dimension(); ++i) {
-        Means(i) = RetMat.col(i).mean();
+    std::vector<unsigned int> chain_N(num_chains);
+    std::vector<VT> chain_mean(num_chains);
+    std::vector<MT> chain_scatter(num_chains);
+    std::vector<Point> chain_end(num_chains, p);
+
+    #pragma omp parallel for num_threads(num_chains) if(num_chains > 1)
+    for (int t = 0; t < int(num_chains); ++t)
+    {
+        chain_N[t] = N / num_chains + (unsigned(t) < N % num_chains ? 1 : 0);
+        std::list<Point> randPoints;
+        PushBackWalkPolicy push_back_policy;
+        if (num_chains > 1) {
+            Polytope Pt(P);
+            RandomPointGenerator::apply(Pt, chain_end[t], std::min(d, chain_N[t]), walk_length,
+                                        randPoints, push_back_policy, rngs[t]);
+            randPoints.clear();
+            RandomPointGenerator::apply(Pt, chain_end[t], chain_N[t], walk_length, randPoints,
+                                        push_back_policy, rngs[t]);
+        } else {
+            RandomPointGenerator::apply(P, chain_end[t], chain_N[t], walk_length, randPoints,
+                                        push_back_policy, rng);
+        }
+
+        MT X(randPoints.size(), d);
+        int jj = 0;
+        for (typename std::list<Point>::iterator rpit = randPoints.begin(); rpit!=randPoints.end(); rpit++, jj++)
+        {
+            X.row(jj) = (*rpit).getCoefficients().transpose();
+        }
+        chain_mean[t] = X.colwise().mean().transpose();
+        X.rowwise() -= chain_mean[t].transpose();
+        chain_scatter[t] = MT::Zero(d, d);
+        chain_scatter[t].template selfadjointView<Eigen::Lower>().rankUpdate(X.transpose());
     }
+    p = chain_end[num_chains - 1];
 
-    for (int i = 0; i < N; ++i) {
-        RetMat.row(i) = RetMat.row(i) - Means.transpose();
+    // merge the scatter matrices of the chains around the mean of the sample
+    Means = VT::Zero(d);
+    for (unsigned int t = 0; t < num_chains; ++t)
+    {
+        Means += NT(chain_N[t]) * chain_mean[t];
+    }
+    Means /= NT(N);
+    MT scatter = MT::Zero(d, d);
+    for (unsigned int t = 0; t < num_chains; ++t)
+    {
+        VT dev = chain_mean[t] - Means;
+        scatter += chain_scatter[t];
+        scatter.template selfadjointView<Eigen::Lower>().rankUpdate(dev, NT(chain_N[t]));
     }
 
-    Eigen::BDCSVD<MT> svd(RetMat, Eigen::ComputeFullV);
-    s = svd.singularValues() / svd.singularValues().minCoeff();
+    // the eigenvalues are in increasing order, the singular values in decreasing
+    Eigen::SelfAdjointEigenSolver<MT> eigensolver(scatter);
+    VT sigma = eigensolver.eigenvalues().reverse().cwiseMax(NT(0)).cwiseSqrt();
+    s = sigma / sigma.minCoeff();
 
     if (s.maxCoeff() >= 2.0) {
         for (int i = 0; i < s.size(); ++i) {
@@ -63,7 +124,7 @@ void svd_on_sample(Polytope &P, Point &p, unsigned int const& num_rounding_steps
                 s(i) = 1.0;
             }
         }
-        V = svd.matrixV();
+        V = eigensolver.eigenvectors().rowwise().reverse();
     } else {
         s = VT::Ones(P.dimension());
         V = MT::Identity(P.dimension(), P.dimension());
@@ -85,7 +146,8 @@ template
 std::tuple<MT, VT, NT> svd_rounding(Polytope &P,
                                     std::pair<Point,NT> &InnerBall,
                                     const unsigned int &walk_length,
-                                    RandomNumberGenerator &rng)
+                                    RandomNumberGenerator &rng,
+                                    unsigned int const& num_threads = 1)
 {
     NT tol = 0.00000001;
     NT R = std::pow(10,10), r = InnerBall.second;
@@ -123,7 +185,7 @@ std::tuple<MT, VT, NT> svd_rounding(Polytope &P,
 
             p = InnerBall.first;
             svd_on_sample<WalkTypePolicy>(P, p, num_rounding_steps, V, s,
-                                          shift, walk_length, rng);
+                                          shift, walk_length, rng, num_threads);
 
             rounding_samples = rounding_samples + num_rounding_steps;
             max_s = s.maxCoeff();
@@ -133,7 +195,7 @@ std::tuple<MT, VT, NT> svd_rounding(Polytope &P,
                     num_rounding_steps = num_rounding_steps * 2;
                     p = InnerBall.first;
                     svd_on_sample<WalkTypePolicy>(P, p, num_rounding_steps, V, s,
-                                                  shift, walk_length, rng);
+                                                  shift, walk_length, rng, num_threads);
                     max_s = s.maxCoeff();
                 } else {
                     last_round_under_p = true;
@@ -168,7 +230,7 @@ std::tuple<MT, VT, NT> svd_rounding(Polytope &P,
         }
     }
 
-    std::tuple<MT, VT, NT> result = std::make_tuple(T, shift, std::abs(T.determinant()));
+    std::tuple<MT, VT, NT> result = std::make_tuple(T, T_shift, std::abs(T.determinant()));
     return result;
 }
 
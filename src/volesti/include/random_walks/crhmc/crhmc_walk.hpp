@@ -20,6 +20,8 @@
 #include "random_walks/crhmc/additional_units/auto_tuner.hpp"
 #include "random_walks/gaussian_helpers.hpp"
 #include <chrono>
+#include <limits>
+#include <vector>
 struct CRHMCWalk {
   template
   <
@@ -106,6 +108,10 @@ struct CRHMCWalk {
     // Auto tuner
     std::unique_ptr<auto_tuner<Sampler, RandomNumberGenerator>>module_update;
 
+    // Generators of the lanes when every chain has its own stream, otherwise
+    // all the lanes draw from the generator of apply
+    std::vector<RandomNumberGenerator> lane_rngs;
+
     // Helper variables
     VT H, H_tilde;
     // Density exponent
@@ -138,6 +144,20 @@ struct CRHMCWalk {
                        params.options.DynamicRegularizer ||
                        params.options.DynamicStepSize;
     };
+    // Give every lane its own generator, seeded by rng
+    void seed_lanes(RandomNumberGenerator &rng)
+    {
+      lane_rngs = std::vector<RandomNumberGenerator>(simdLen, rng);
+      for (int i = 0; i < simdLen; i++)
+      {
+        lane_rngs[i].set_seed((unsigned int)(rng.sample_urdist()
+                              * NT(std::numeric_limits<unsigned int>::max())));
+      }
+    }
+    inline RandomNumberGenerator &lane_rng(RandomNumberGenerator &rng, int i)
+    {
+      return lane_rngs.empty() ? rng : lane_rngs[i];
+    }
     // Sample a new velocity with momentum
     MT get_direction_with_momentum(unsigned int const &dim,
                                 RandomNumberGenerator &rng, MT const &x, MT v,
@@ -146,7 +166,7 @@ struct CRHMCWalk {
       MT z = MT(dim, simdLen);
       for (int i = 0; i < simdLen; i++)
       {
-        z.col(i) = GetDirection<Point>::apply(dim, rng, normalize).getCoefficients();
+        z.col(i) = GetDirection<Point>::apply(dim, lane_rng(rng, i), normalize).getCoefficients();
       }
       solver->ham.move({x, v});
       MT sqrthess = (solver->ham.hess).cwiseSqrt();
@@ -203,7 +223,7 @@ struct CRHMCWalk {
         VT rng_vector = VT(simdLen);
         for (int i = 0; i < simdLen; i++)
         {
-          rng_vector(i) = rng.sample_urdist();
+          rng_vector(i) = lane_rng(rng, i).sample_urdist();
         }
         accept = (rng_vector.array() < prob.array()).select(1 * IVT::Ones(simdLen), 0 * IVT::Ones(simdLen));
 
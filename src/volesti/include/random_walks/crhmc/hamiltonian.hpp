@@ -66,6 +66,7 @@ public:
     xs = {x, x};
     lsc = MT::Zero(simdLen, n);
     solver.accuracyThreshold = options.solver_accuracy_threshold;
+    solver.numThreads = options.num_threads;
     if (options.DynamicWeight)
     {
       weighted_barrier =
@@ -97,6 +97,90 @@ void uniform_sampling(PointList &randPoints,
 }
 
 
+// Uniform sampling with online rounding. The chain runs in a copy of P that is
+// mapped by x = T y + shift, where x are the coordinates of P, and every sample,
+// including those of the burn-in, updates the running mean and covariance of the
+// chain in the coordinates of P. After every rounding period the copy of P is
+// replaced by P transformed by the Cholesky factor of the covariance, if the
+// current body is not round yet (the ratio of the axes of the covariance in the
+// current coordinates is larger than 2), and the point of the chain is mapped to
+// the new coordinates. The period doubles after every rounding so that the
+// adaptation vanishes. All the samples are returned in the coordinates of P.
+template <typename WalkTypePolicy,
+          typename PointList,
+          typename Polytope,
+          typename RandomNumberGenerator,
+          typename Point
+        >
+void uniform_sampling_online_rounding(PointList &randPoints,
+                                      Polytope &P,
+                                      RandomNumberGenerator &rng,
+                                      const unsigned int &walk_len,
+                                      const unsigned int &rnum,
+                                      const Point &starting_point,
+                                      unsigned int const& nburns,
+                                      unsigned int rounding_period = 0)
+{
+    typedef typename WalkTypePolicy::template Walk
+            <
+                    Polytope,
+                    RandomNumberGenerator
+            > walk;
+    typedef typename Point::FT NT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, 1> VT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+    typedef RandomPointGenerator <walk> RandomPointGenerator;
+
+    const unsigned int d = P.dimension();
+    if (rounding_period == 0) rounding_period = 10 * d;
+
+    PushBackWalkPolicy push_back_policy;
+    Polytope Q(P);
+    MT T = MT::Identity(d, d);
+    VT shift = VT::Zero(d), mean = VT::Zero(d), x(d), delta(d);
+    MT M2 = MT::Zero(d, d);
+    unsigned int num_samples = 0, total = nburns + rnum, next_rounding = rounding_period;
+
+    Point p = starting_point;
+    PointList chunk;
+    while (num_samples < total)
+    {
+        chunk.clear();
+        RandomPointGenerator::apply(Q, p, std::min(next_rounding, total) - num_samples, walk_len,
+                                    chunk, push_back_policy, rng);
+        for (auto it = chunk.begin(); it != chunk.end(); ++it)
+        {
+            x.noalias() = T * it->getCoefficients() + shift;
+            // Welford update of the mean and of the lower part of the scatter matrix
+            num_samples++;
+            delta = x - mean;
+            mean += delta / NT(num_samples);
+            M2.template selfadjointView<Eigen::Lower>().rankUpdate(delta, NT(num_samples - 1) / NT(num_samples));
+            if (num_samples > nburns) randPoints.push_back(Point(x));
+        }
+        if (num_samples < next_rounding || num_samples >= total) continue;
+        next_rounding += (rounding_period *= 2);
+
+        Eigen::LLT<MT> llt(M2 / NT(num_samples - 1));
+        if (llt.info() != Eigen::Success) continue;
+        MT L = llt.matrixL();
+
+        // the axes of the covariance in the current coordinates are the singular values of T^{-1} L
+        Eigen::JacobiSVD<MT> svd(T.template triangularView<Eigen::Lower>().solve(L));
+        if (svd.singularValues().maxCoeff() <= NT(2) * svd.singularValues().minCoeff()) continue;
+
+        x.noalias() = T * p.getCoefficients() + shift;
+        T = L;
+        shift = mean;
+        p = Point(VT(L.template triangularView<Eigen::Lower>().solve(x - shift)));
+        Q = P;
+        Q.shift(shift);
+        Q.linear_transformIt(T);
+        Q.ComputeInnerBall();
+    }
+}
+
+
 template
 <
         typename WalkTypePolicy,
@@ -307,8 +391,10 @@ void crhmc_sampling(PointList &randPoints,
                     NegativeGradientFunctor &F,
                     NegativeLogprobFunctor &f,
                     HessianFunctor &h,
-                    int simdLen = 1,
-                    bool raw_output=false) {
+                    int num_chains = 1,
+                    bool raw_output=false,
+                    std::string const& cache_directory = std::string(),
+                    unsigned int const& num_threads = 1) {
   typedef  typename Polytope::MT MatrixType;
   typedef  crhmc_input
           <
@@ -320,7 +406,9 @@ void crhmc_sampling(PointList &randPoints,
           > Input;
   Input input = convert2crhmc_input<Input, Polytope, NegativeLogprobFunctor, NegativeGradientFunctor, HessianFunctor>(P, f, F, h);
   typedef crhmc_problem<Point, Input> CrhmcProblem;
-  CrhmcProblem problem = CrhmcProblem(input);
+  typename CrhmcProblem::Opts options;
+  options.num_threads = num_threads;
+  CrhmcProblem problem = CrhmcProblem(input, options, cache_directory);
   if(problem.terminate){return;}
   typedef typename WalkTypePolicy::template Walk
           <
@@ -337,7 +425,9 @@ void crhmc_sampling(PointList &randPoints,
                   NegativeGradientFunctor
           > walk_params;
   Point p = Point(problem.center);
-  problem.options.simdLen=simdLen;
+  // the chains run on the packed lanes of the solver, thus num_chains has to be
+  // the simdLen that the Solver is instantiated for
+  problem.options.simdLen=num_chains;
   walk_params params(input.df, p.dimension(), problem.options);
 
   if (input.df.params.eta > 0) {
@@ -347,6 +437,11 @@ void crhmc_sampling(PointList &randPoints,
   PushBackWalkPolicy push_back_policy;
 
   walk crhmc_walk = walk(problem, p, input.df, input.f, params);
+  // every chain starts from the center and leaves it with its own stream, so
+  // after the burn-in the chains are independent of each other
+  if (num_chains > 1) {
+    crhmc_walk.seed_lanes(rng);
+  }
 
   typedef CrhmcRandomPointGenerator<walk> RandomPointGenerator;
 
@@ -355,7 +450,19 @@ void crhmc_sampling(PointList &randPoints,
   //crhmc_walk.disable_adaptive();
   randPoints.clear();
   RandomPointGenerator::apply(problem, p, rnum, walk_len, randPoints,
-                              push_back_policy, rng, F, f, params, crhmc_walk, simdLen, raw_output);
+                              push_back_policy, rng, F, f, params, crhmc_walk, num_chains, raw_output);
+
+  // the generator returns the lanes of every step together; the points of
+  // each chain are made a consecutive block of randPoints
+  if (num_chains > 1) {
+    std::vector<Point> steps(randPoints.begin(), randPoints.end());
+    randPoints.clear();
+    for (int j = 0; j < num_chains; j++) {
+      for (std::size_t i = j; i < steps.size(); i += num_chains) {
+        randPoints.push_back(steps[i]);
+      }
+    }
+  }
 }
 #include "ode_solvers/ode_solvers.hpp"
 template <
@@ -371,7 +478,9 @@ template <
 void execute_crhmc(Polytope &P, RNGType &rng, PointList &randPoints,
                   unsigned int const& walkL, unsigned int const& numpoints,
                   unsigned int const& nburns, NegativeGradientFunctor *F=NULL,
-                  NegativeLogprobFunctor *f=NULL, HessianFunctor *h=NULL, bool raw_output= false){
+                  NegativeLogprobFunctor *f=NULL, HessianFunctor *h=NULL, bool raw_output= false,
+                  std::string const& cache_directory = std::string(),
+                  unsigned int const& num_threads = 1){
 typedef typename Polytope::MT MatrixType;
 typedef typename Polytope::PointType Point;
 typedef typename Point::FT NT;
@@ -402,7 +511,7 @@ crhmc_sampling <
   NegativeGradientFunctor,
   simdLen
   >
->(randPoints, P, rng, walkL, numpoints, nburns, *F, *f, *h, simdLen, raw_output);
+>(randPoints, P, rng, walkL, numpoints, nburns, *F, *f, *h, simdLen, raw_output, cache_directory, num_threads);
 }else{
   typedef  crhmc_input
         <
@@ -431,8 +540,62 @@ crhmc_sampling <
   NegativeGradientFunctor,
   simdLen
   >
->(randPoints, P, rng, walkL, numpoints, nburns, *F, *f, zerof, simdLen, raw_output);
+>(randPoints, P, rng, walkL, numpoints, nburns, *F, *f, zerof, simdLen, raw_output, cache_directory, num_threads);
+}
+}
+
+// The crhmc walk is instantiated for simdLen = 1, 4 and 8 chains that share each
+// pass of the packed Cholesky factorization. A zero simdLen is chosen from the
+// cpu at run time: one lane per double of its widest vector register.
+inline int crhmc_simd_len(int const& simdLen)
+{
+  if (simdLen == 0) {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return 8;
+    if (__builtin_cpu_supports("avx2")) return 4;
+#endif
+    return 1;
+  }
+  if (simdLen != 1 && simdLen != 4 && simdLen != 8) {
+    throw std::runtime_error("The simd length of crhmc should be 1, 4 or 8.");
+  }
+  return simdLen;
 }
+
+template <
+        typename Polytope,
+        typename RNGType,
+        typename PointList,
+        typename NegativeGradientFunctor,
+        typename NegativeLogprobFunctor,
+        typename HessianFunctor,
+        typename CRHMCWalk
+>
+void execute_crhmc(Polytope &P, RNGType &rng, PointList &randPoints,
+                   unsigned int const& walkL, unsigned int const& numpoints,
+                   unsigned int const& nburns, int const& simdLen,
+                   NegativeGradientFunctor *F, NegativeLogprobFunctor *f,
+                   HessianFunctor *h, bool raw_output = false,
+                   std::string const& cache_directory = std::string(),
+                   unsigned int const& num_threads = 1)
+{
+  switch (crhmc_simd_len(simdLen)) {
+  case 8:
+    execute_crhmc<Polytope, RNGType, PointList, NegativeGradientFunctor, NegativeLogprobFunctor,
+                  HessianFunctor, CRHMCWalk, 8>
+        (P, rng, randPoints, walkL, numpoints, nburns, F, f, h, raw_output, cache_directory, num_threads);
+    break;
+  case 4:
+    execute_crhmc<Polytope, RNGType, PointList, NegativeGradientFunctor, NegativeLogprobFunctor,
+                  HessianFunctor, CRHMCWalk, 4>
+        (P, rng, randPoints, walkL, numpoints, nburns, F, f, h, raw_output, cache_directory, num_threads);
+    break;
+  default:
+    execute_crhmc<Polytope, RNGType, PointList, NegativeGradientFunctor, NegativeLogprobFunctor,
+                  HessianFunctor, CRHMCWalk, 1>
+        (P, rng, randPoints, walkL, numpoints, nburns, F, f, h, raw_output, cache_directory, num_threads);
+  }
 }
 template
 <
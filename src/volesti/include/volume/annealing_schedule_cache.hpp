@@ -0,0 +1,141 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2024 Vissarion Fisikopoulos
+// Copyright (c) 2018-2024 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+#ifndef ANNEALING_SCHEDULE_CACHE_HPP
+#define ANNEALING_SCHEDULE_CACHE_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <Eigen/Eigen>
+
+#include "misc/binary_cache_utils.hpp"
+
+
+/// A cache of annealing schedules for repeated volume computations of the same body.
+/// A schedule is stored under a hash of the body, as given to the volume algorithm
+/// (i.e. after any rounding), and of the parameters the schedule depends on.
+/// The most recently used schedules are kept in memory; if a directory is given,
+/// every schedule is also written there and the memory misses are looked up on disk.
+/// \tparam NT Numerical Type
+template <typename NT>
+class AnnealingScheduleCache
+{
+    static constexpr char magic[8] = {'V', 'O', 'L', 'S', 'C', 'H', 'D', '1'};
+
+    struct Entry {
+        std::uint64_t key;
+        std::vector<NT> schedule;  // squared radii of the balls or variances a_i
+        std::vector<NT> ratios;    // the ratios of the balls of CB, empty for CG
+    };
+
+    std::list<Entry> _entries;
+    unsigned int _max_size;
+    std::string _directory;
+
+    std::string path(std::uint64_t const& key) const
+    {
+        return binary_cache_path(_directory, key, "sched");
+    }
+
+    void insert_in_memory(Entry const& entry)
+    {
+        _entries.push_front(entry);
+        if (_entries.size() > _max_size) _entries.pop_back();
+    }
+
+    bool find_on_disk(std::uint64_t const& key, Entry &entry) const
+    {
+        std::ifstream is(path(key), std::ios::binary);
+        if (!is || !read_binary_cache_header<NT>(is, magic, key)) return false;
+        entry.key = key;
+        return read_binary_vector(is, entry.schedule) && read_binary_vector(is, entry.ratios)
+               && !entry.schedule.empty();
+    }
+
+    void insert_on_disk(Entry const& entry) const
+    {
+        write_binary_cache_file<NT>(path(entry.key), magic, entry.key, [&](std::ostream &os) {
+            write_binary_vector(os, entry.schedule);
+            write_binary_vector(os, entry.ratios);
+        });
+    }
+
+public:
+    AnnealingScheduleCache(unsigned int const& max_size = 32,
+                           std::string const& directory = std::string())
+        :   _max_size(max_size)
+        ,   _directory(directory)
+    {}
+
+    void set_directory(std::string const& directory)
+    {
+        _directory = directory;
+    }
+
+    unsigned int size() const
+    {
+        return _entries.size();
+    }
+
+    void clear()
+    {
+        _entries.clear();
+    }
+
+    // the key of the schedule of P for the given parameters
+    template <typename Polytope, typename... Parameters>
+    static std::uint64_t key(Polytope const& P, Parameters const&... parameters)
+    {
+        fnv1a_hasher h;
+        h.add_polytope(P);
+        int unpack[] = {0, (h.add(parameters), 0)...};
+        (void)unpack;
+        return h.value();
+    }
+
+    bool find(std::uint64_t const& key, std::vector<NT> &schedule, std::vector<NT> &ratios)
+    {
+        for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+            if (it->key == key) {
+                _entries.splice(_entries.begin(), _entries, it);
+                schedule = it->schedule;
+                ratios = it->ratios;
+                return true;
+            }
+        }
+        Entry entry;
+        if (_directory.empty() || !find_on_disk(key, entry)) return false;
+        insert_in_memory(entry);
+        schedule = entry.schedule;
+        ratios = entry.ratios;
+        return true;
+    }
+
+    void insert(std::uint64_t const& key, std::vector<NT> const& schedule,
+                std::vector<NT> const& ratios = std::vector<NT>())
+    {
+        Entry entry{key, schedule, ratios};
+        for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+            if (it->key == key) {
+                _entries.erase(it);
+                break;
+            }
+        }
+        insert_in_memory(entry);
+        if (!_directory.empty()) insert_on_disk(entry);
+    }
+};
+
+template <typename NT>
+constexpr char AnnealingScheduleCache<NT>::magic[8];
+
+#endif // ANNEALING_SCHEDULE_CACHE_HPP
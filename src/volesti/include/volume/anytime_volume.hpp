@@ -0,0 +1,183 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2024 Vissarion Fisikopoulos
+// Copyright (c) 2018-2024 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+#ifndef ANYTIME_VOLUME_HPP
+#define ANYTIME_VOLUME_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <vector>
+#include <boost/math/distributions/normal.hpp>
+
+
+/// The estimate of the logarithm of the volume at some point of the computation
+/// and its confidence interval
+template <typename NT>
+struct volume_estimate
+{
+    unsigned int phases_done;
+    double seconds;
+    std::size_t steps;
+    NT log_volume;
+    NT log_lower;
+    NT log_upper;
+};
+
+
+/// Tracks the running estimate of a multiphase volume algorithm, i.e. the sum of
+/// the logarithms of the ratios of its phases. Until a phase is estimated its ratio
+/// is the rough one of the annealing schedule, thus an estimate exists as soon as
+/// the schedule is known. The variance of every log-ratio follows from the delta
+/// method and the confidence interval assumes that the phases are independent.
+///
+/// Every update is appended to a trace and passed to an optional callback; the
+/// computation stops early when the callback returns true or the time budget
+/// has elapsed, and the volume algorithm then returns the current estimate.
+/// \tparam NT Numerical Type
+template <typename NT>
+class AnytimeVolume
+{
+    typedef std::chrono::steady_clock clock;
+
+public:
+    typedef std::function<bool(volume_estimate<NT> const&)> Callback;
+
+private:
+    double _time_budget;
+    unsigned int _stride;
+    Callback _callback;
+    NT _z;
+    clock::time_point _start;
+    NT _log_offset;
+    std::vector<NT> _log_ratios;
+    std::vector<NT> _variances;
+    std::vector<char> _done;
+    unsigned int _phases_done;
+    std::atomic<std::size_t> _steps;
+    std::atomic<bool> _stopped;
+    std::vector<volume_estimate<NT>> _trace;
+
+    void record()
+    {
+        NT log_volume = _log_offset, variance = NT(0);
+        for (std::size_t i = 0; i < _log_ratios.size(); ++i) {
+            log_volume += _log_ratios[i];
+            variance += _variances[i];
+        }
+        NT half_width = _z * std::sqrt(variance);
+        volume_estimate<NT> estimate = {_phases_done, elapsed(), _steps, log_volume,
+                                        log_volume - half_width, log_volume + half_width};
+        _trace.push_back(estimate);
+        if ((_callback && _callback(estimate)) || expired()) _stopped = true;
+    }
+
+public:
+    // time_budget is in seconds; a running phase reports its estimate every stride
+    // samples, prob is the confidence level of the intervals
+    AnytimeVolume(double const& time_budget = std::numeric_limits<double>::infinity(),
+                  unsigned int const& stride = 1000,
+                  Callback const& callback = Callback(),
+                  NT const& prob = NT(0.95))
+        :   _time_budget(time_budget)
+        ,   _stride(stride > 0 ? stride : 1)
+        ,   _callback(callback)
+        ,   _start(clock::now())
+        ,   _log_offset(0)
+        ,   _phases_done(0)
+        ,   _steps(0)
+        ,   _stopped(false)
+    {
+        boost::math::normal dist(0.0, 1.0);
+        _z = boost::math::quantile(boost::math::complement(dist, (1.0 - prob) / 2.0));
+    }
+
+    unsigned int stride() const
+    {
+        return _stride;
+    }
+
+    double elapsed() const
+    {
+        return std::chrono::duration<double>(clock::now() - _start).count();
+    }
+
+    bool expired() const
+    {
+        return elapsed() >= _time_budget;
+    }
+
+    bool stopped() const
+    {
+        return _stopped;
+    }
+
+    // a constant added to the log-volume, e.g. the logarithm of a rounding factor
+    void add_log_factor(NT const& log_factor)
+    {
+        _log_offset += log_factor;
+    }
+
+    // Called by the volume algorithm once the schedule is known, with the logarithm
+    // of the volume of its base body and the rough log-ratios of the phases
+    void start(NT const& log_base, std::vector<NT> const& log_ratios,
+               std::vector<NT> const& variances)
+    {
+        _log_offset += log_base;
+        _log_ratios = log_ratios;
+        _variances = variances;
+        _done.assign(log_ratios.size(), 0);
+        _phases_done = 0;
+        record();
+    }
+
+    // the estimate of the i-th phase, done is false while the phase is running;
+    // return true if the computation has to stop
+    bool update(unsigned int const& i, NT const& log_ratio, NT const& variance,
+                bool const& done)
+    {
+        _log_ratios[i] = log_ratio;
+        _variances[i] = variance;
+        if (done && !_done[i]) {
+            _done[i] = 1;
+            _phases_done++;
+        }
+        record();
+        return _stopped;
+    }
+
+    // the steps of the random walks of the phases, they are counted by the next report
+    void add_steps(std::size_t const& steps)
+    {
+        _steps += steps;
+    }
+
+    NT log_ratio(unsigned int const& i) const
+    {
+        return _log_ratios[i];
+    }
+
+    // true if every phase has reached the requested error
+    bool converged() const
+    {
+        return !_log_ratios.empty() && _phases_done == _log_ratios.size();
+    }
+
+    volume_estimate<NT> const& current() const
+    {
+        return _trace.back();
+    }
+
+    std::vector<volume_estimate<NT>> const& trace() const
+    {
+        return _trace;
+    }
+};
+
+#endif // ANYTIME_VOLUME_HPP
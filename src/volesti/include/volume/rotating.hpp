@@ -10,6 +10,7 @@
 #define ROTATING_H
 
 #include <Eigen/Eigen>
+#include <boost/random/bernoulli_distribution.hpp>
 
 template <typename MT, typename Polytope>
 MT rotating(Polytope &P){
@@ -61,4 +62,124 @@ MT rotating(Polytope &P, unsigned seed){
     return svd.matrixU().inverse();
 }
 
+
+/// A structured random rotation R = (H D_3) (H D_2) (H D_1) where D_i are random
+/// diagonal sign matrices and H applies a normalized Walsh-Hadamard transform to the
+/// first p and then to the last p coordinates, p being the largest power of 2 <= d.
+/// Every factor is orthogonal, so R is a rotation. R and R^T are applied to a vector
+/// in O(d log d) and are never stored, so points can be mapped back cheaply.
+/// \tparam NT Numerical Type
+template <typename NT>
+class HadamardRotation {
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, 1> VT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+
+    static const unsigned int num_rounds = 3;
+    unsigned int d, p;
+    MT signs; // column i holds the diagonal of D_{i+1}
+
+    // in-place normalized fast Walsh-Hadamard transform of p entries starting at x
+    void fwht(NT *x) const
+    {
+        for (unsigned int h = 1; h < p; h *= 2) {
+            for (unsigned int i = 0; i < p; i += 2 * h) {
+                for (unsigned int j = i; j < i + h; ++j) {
+                    NT a = x[j], b = x[j + h];
+                    x[j] = a + b;
+                    x[j + h] = a - b;
+                }
+            }
+        }
+        NT scale = NT(1) / std::sqrt(NT(p));
+        for (unsigned int j = 0; j < p; ++j) x[j] *= scale;
+    }
+
+    // H is symmetric and H^2 = I, i.e. it is its own inverse
+    void apply_H(NT *x) const
+    {
+        fwht(x);
+        if (p < d) fwht(x + d - p);
+    }
+
+    void apply_H_transpose(NT *x) const
+    {
+        if (p < d) fwht(x + d - p);
+        fwht(x);
+    }
+
+public:
+    template <typename RNGType>
+    HadamardRotation(unsigned int const& dim, RNGType &rng) : d(dim), p(1)
+    {
+        while (2 * p <= d) p *= 2;
+        boost::random::bernoulli_distribution<> coin;
+        signs.resize(d, num_rounds);
+        for (unsigned int r = 0; r < num_rounds; ++r) {
+            for (unsigned int i = 0; i < d; ++i) {
+                signs(i, r) = coin(rng) ? NT(1) : NT(-1);
+            }
+        }
+    }
+
+    // x <- R x
+    void apply(VT &x) const
+    {
+        for (unsigned int r = 0; r < num_rounds; ++r) {
+            x = x.cwiseProduct(signs.col(r));
+            apply_H(x.data());
+        }
+    }
+
+    // x <- R^T x
+    void apply_transpose(VT &x) const
+    {
+        for (int r = num_rounds - 1; r >= 0; --r) {
+            apply_H_transpose(x.data());
+            x = x.cwiseProduct(signs.col(r));
+        }
+    }
+
+    // M <- M R^T, i.e. apply R to every row of M
+    void apply_to_rows(MT &M) const
+    {
+        VT row(d);
+        for (int i = 0; i < M.rows(); ++i) {
+            row = M.row(i).transpose();
+            apply(row);
+            M.row(i) = row.transpose();
+        }
+    }
+
+    // the dense d x d matrix of R
+    MT matrix() const
+    {
+        MT R = MT::Identity(d, d);
+        VT col(d);
+        for (unsigned int j = 0; j < d; ++j) {
+            col = R.col(j);
+            apply(col);
+            R.col(j) = col;
+        }
+        return R;
+    }
+};
+
+
+// apply a structured random rotation y = R x to the polytope P in O(m d log d),
+// i.e. every row of P.get_mat() (normal vectors, vertices or generators) is rotated by R.
+// The returned matrix follows the convention of rotating(), i.e. T = R
+template <typename MT, typename Polytope>
+MT hadamard_rotating(Polytope &P, unsigned seed){
+
+    typedef typename Polytope::NT NT;
+    boost::mt19937 rng(seed);
+
+    HadamardRotation<NT> R(P.dimension(), rng);
+    MT A = P.get_mat();
+    R.apply_to_rows(A);
+    P.set_mat(A);
+
+    return R.matrix();
+}
+
 #endif
@@ -0,0 +1,228 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2024 Vissarion Fisikopoulos
+// Copyright (c) 2018-2024 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+#ifndef VOLUME_CHECKPOINT_HPP
+#define VOLUME_CHECKPOINT_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "misc/binary_cache_utils.hpp"
+
+
+enum volume_checkpoint_algorithm
+{
+    checkpoint_cooling_balls = 1,
+    checkpoint_cooling_gaussians = 2,
+    checkpoint_cooling_gaussians_crhmc = 3
+};
+
+/// The state of a volume computation at the end of a step of its schedule or its
+/// phases. The volume algorithms store only what they can not recompute cheaply:
+/// the annealing schedule, the estimates of the completed phases and, for the
+/// cooling gaussians, the running estimator of the current phase and the points
+/// of the chains. The random number generator is reseeded at every save and only
+/// the seed is stored, thus a resumed run continues exactly as the run that wrote
+/// the checkpoint. The concurrent phases of CB do not reseed it; they draw their
+/// seeds from the seed that is stored with the schedule.
+/// A checkpoint also stores a fingerprint of the body, so it is resumed only on it.
+/// \tparam NT Numerical Type
+template <typename NT>
+struct volume_checkpoint
+{
+    unsigned int algorithm = 0;
+    unsigned int dimension = 0;
+    unsigned int rng_seed = 0;
+    unsigned int rounding_seed = 0;   // the seed of the rounding step, if any
+    unsigned int schedule_done = 0;
+    std::uint64_t fingerprint = 0;    // the hash of the body, see polytope_fingerprint
+    std::vector<NT> schedule;         // squared radii of the balls or variances a_i
+    std::vector<NT> schedule_ratios;  // the ratios of the balls of CB
+    std::vector<unsigned int> phase_done;
+    std::vector<NT> phase_values;     // the estimates of the phases
+    std::vector<NT> window;           // the estimator of the current phase
+    std::vector<NT> points;           // the points of the chains, one after the other
+};
+
+
+// store the points of the chains in the checkpoint
+template <typename NT, typename Point>
+void store_points(volume_checkpoint<NT> &state, std::vector<Point> const& points)
+{
+    state.points.clear();
+    for (Point const& p : points) {
+        for (unsigned int j = 0; j < p.dimension(); ++j) state.points.push_back(p[j]);
+    }
+}
+
+// restore the points of the chains; if a resumed run uses more chains than the
+// run that wrote the checkpoint, the stored points are used cyclically
+template <typename NT, typename Point>
+void restore_points(volume_checkpoint<NT> const& state, std::vector<Point> &points)
+{
+    const std::size_t stored = state.points.size() / state.dimension;
+    if (stored == 0) return;
+    for (std::size_t t = 0; t < points.size(); ++t) {
+        std::size_t offset = (t % stored) * state.dimension;
+        for (unsigned int j = 0; j < state.dimension; ++j) {
+            points[t].set_coord(j, state.points[offset + j]);
+        }
+    }
+}
+
+
+/// Writes a volume_checkpoint to a binary file every time that a given interval has
+/// elapsed and loads it back to resume a computation. A checkpoint is written to a
+/// temporary file that replaces the previous one, so an interrupted save never
+/// corrupts the last checkpoint.
+/// \tparam NT Numerical Type
+template <typename NT>
+class VolumeCheckpointer
+{
+    typedef std::chrono::steady_clock clock;
+
+    static constexpr char magic[8] = {'V', 'O', 'L', 'C', 'K', 'P', 'T', '2'};
+
+    std::string _filename;
+    double _interval;
+    bool _loaded;
+    volume_checkpoint<NT> _state;
+    clock::time_point _last_save;
+
+public:
+    // interval is the minimum number of seconds between two saves
+    VolumeCheckpointer(std::string const& filename, double const& interval = 60.0)
+        :   _filename(filename)
+        ,   _interval(interval)
+        ,   _loaded(false)
+        ,   _last_save(clock::now())
+    {}
+
+    volume_checkpoint<NT>& state()
+    {
+        return _state;
+    }
+
+    bool loaded() const
+    {
+        return _loaded;
+    }
+
+    // load the checkpoint that a previous run wrote in filename
+    void load(std::string const& filename)
+    {
+        std::ifstream is(filename, std::ios::binary);
+        if (!is) throw std::runtime_error("Unable to open the checkpoint file " + filename + "!");
+
+        char header[8];
+        std::uint32_t fields[6];
+        is.read(header, sizeof(header));
+        is.read(reinterpret_cast<char*>(fields), sizeof(fields));
+        is.read(reinterpret_cast<char*>(&_state.fingerprint), sizeof(_state.fingerprint));
+        if (!is || std::memcmp(header, magic, sizeof(magic)) != 0 || fields[0] != sizeof(NT)) {
+            throw std::runtime_error(filename + " is not a volume checkpoint!");
+        }
+        _state.algorithm = fields[1];
+        _state.dimension = fields[2];
+        _state.rng_seed = fields[3];
+        _state.rounding_seed = fields[4];
+        _state.schedule_done = fields[5];
+        if (!read_binary_vector(is, _state.schedule)
+            || !read_binary_vector(is, _state.schedule_ratios)
+            || !read_binary_vector(is, _state.phase_done)
+            || !read_binary_vector(is, _state.phase_values)
+            || !read_binary_vector(is, _state.window)
+            || !read_binary_vector(is, _state.points)) {
+            throw std::runtime_error("The checkpoint file is corrupted!");
+        }
+
+        _loaded = true;
+    }
+
+    // Called by the volume algorithms before they start, fingerprint is the hash of their body.
+    // Return true if the loaded checkpoint has to be resumed, otherwise start a new one
+    bool resume(volume_checkpoint_algorithm const& algorithm, unsigned int const& dimension,
+                std::uint64_t const& fingerprint)
+    {
+        if (_loaded) {
+            if (_state.algorithm != (unsigned int)(algorithm) || _state.dimension != dimension
+                || _state.fingerprint != fingerprint) {
+                throw std::runtime_error("The checkpoint was written by a different volume computation!");
+            }
+            return true;
+        }
+        unsigned int rounding_seed = _state.rounding_seed;
+        _state = volume_checkpoint<NT>();
+        _state.algorithm = algorithm;
+        _state.dimension = dimension;
+        _state.fingerprint = fingerprint;
+        _state.rounding_seed = rounding_seed;
+        return false;
+    }
+
+    // true if the interval has elapsed since the last save
+    bool due() const
+    {
+        return std::chrono::duration<double>(clock::now() - _last_save).count() >= _interval;
+    }
+
+    template <typename RandomNumberGenerator>
+    void restore_rng(RandomNumberGenerator &rng) const
+    {
+        rng.set_seed(_state.rng_seed);
+    }
+
+    // reseed rng and write the state; the caller has to restart anything that
+    // depends on the previous stream of rng, as it would do after a resume
+    template <typename RandomNumberGenerator>
+    void save(RandomNumberGenerator &rng)
+    {
+        _state.rng_seed = (unsigned int)(rng.sample_urdist()
+                                         * NT(std::numeric_limits<unsigned int>::max()));
+        rng.set_seed(_state.rng_seed);
+        save();
+    }
+
+    // write the state with the stored seed, for callers that do not use rng
+    // after their previous save
+    void save()
+    {
+        std::string tmp = _filename + ".tmp";
+        {
+            std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+            std::uint32_t fields[6] = {(std::uint32_t)(sizeof(NT)), _state.algorithm,
+                                       _state.dimension, _state.rng_seed,
+                                       _state.rounding_seed, _state.schedule_done};
+            os.write(magic, sizeof(magic));
+            os.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+            os.write(reinterpret_cast<const char*>(&_state.fingerprint), sizeof(_state.fingerprint));
+            write_binary_vector(os, _state.schedule);
+            write_binary_vector(os, _state.schedule_ratios);
+            write_binary_vector(os, _state.phase_done);
+            write_binary_vector(os, _state.phase_values);
+            write_binary_vector(os, _state.window);
+            write_binary_vector(os, _state.points);
+            if (!os) throw std::runtime_error("Unable to write the checkpoint file " + tmp + "!");
+        }
+        if (!replace_file(tmp, _filename)) {
+            throw std::runtime_error("Unable to write the checkpoint file " + _filename + "!");
+        }
+        _last_save = clock::now();
+    }
+};
+
+template <typename NT>
+constexpr char VolumeCheckpointer<NT>::magic[8];
+
+#endif // VOLUME_CHECKPOINT_HPP
@@ -10,6 +10,8 @@
 #ifndef VOLUME_COOLING_BALLS_HPP
 #define VOLUME_COOLING_BALLS_HPP
 
+#include <exception>
+#include <string>
 #include <boost/math/distributions/students_t.hpp>
 #include <boost/math/special_functions/erf.hpp>
 
@@ -25,6 +27,9 @@
 #include "convex_bodies/ballintersectconvex.h"
 #include "sampling/random_point_generators.hpp"
 #include "volume/math_helpers.hpp"
+#include "volume/volume_checkpoint.hpp"
+#include "volume/annealing_schedule_cache.hpp"
+#include "volume/anytime_volume.hpp"
 
 
 ////////////////////////////////////
@@ -287,7 +292,8 @@ bool get_sequence_of_polytopeballs(Polytope &P,
                                    NT const& radius,
                                    unsigned int const& walk_length,
                                    cooling_ball_parameters<NT> const& parameters,
-                                   RNG& rng)
+                                   RNG& rng,
+                                   std::vector<std::list<typename Polytope::PointType>>* samples = NULL)
 {
     typedef typename Polytope::PointType Point;
     bool fail;
@@ -309,6 +315,9 @@ bool get_sequence_of_polytopeballs(Polytope &P,
     RandomPointGenerator::apply(P, q, Ntot, walk_length,
                                 randPoints, push_back_policy, rng);
 
+    // the i-th sample is uniform in P \cap B_{i-1}, the body of the (i+1)-th phase
+    if (samples != NULL) samples->push_back(randPoints);
+
     if (check_convergence<Point>(B0, randPoints,
                                  fail, ratio, parameters.nu,
                                  false, true, parameters))
@@ -332,6 +341,7 @@ bool get_sequence_of_polytopeballs(Polytope &P,
 
         RandomPointGenerator::apply(zb_it, q, Ntot, walk_length,
                                     randPoints, push_back_policy, rng);
+        if (samples != NULL) samples->push_back(randPoints);
         if (check_convergence<Point>(B0, randPoints, fail, ratio, parameters.nu,
                                      false, true, parameters))
         {
@@ -604,13 +614,75 @@ bool estimate_ratio_interval_generic(Pollyball &Pb2,
     return true;
 }
 
+/// The sample of the ball annealing that a phase reuses, uniform in its body.
+/// The sample that the schedule drew in the body gives the prior counts of the
+/// estimation; replayed, it also fills the sliding window and its last point
+/// starts the chain. Each sample comes from its own chain, so the phases stay
+/// independent, as their split of the error assumes. For the same reason the
+/// points of a phase are not passed on to the next one, even those in its ball.
+template <typename Point>
+struct recycled_samples
+{
+    std::list<Point> schedule;
+};
+
+// the default observer of the ratio estimation, it never stops the estimation
+struct no_ratio_observer
+{
+    template <typename NT>
+    bool operator()(estimate_ratio_interval_parameters<NT> const&) const
+    {
+        return false;
+    }
+
+    void walked(unsigned int const&) const {}
+};
+
+// passes the running estimate of the i-th phase of the ball annealing to an
+// AnytimeVolume every stride samples and stops the phase if the computation has to stop
+template <typename NT>
+struct anytime_phase_observer
+{
+    anytime_phase_observer(AnytimeVolume<NT>* progress, int const& phase)
+        :   progress(progress)
+        ,   phase(phase)
+        ,   interrupted(false)
+    {}
+
+    bool operator()(estimate_ratio_interval_parameters<NT> const& parameters)
+    {
+        if (progress == NULL || parameters.iter % progress->stride() != 0) return false;
+
+        // phase 0 estimates the ratio itself, the others its inverse
+        NT val = NT(parameters.count_in) / NT(parameters.tot_count);
+        NT log_ratio = (phase == 0) ? std::log(val) : -std::log(val);
+        NT variance = (parameters.s * parameters.s) / (val * val);
+        bool stop;
+        #pragma omp critical(anytime_volume)
+        stop = progress->update(phase, log_ratio, variance, false);
+        interrupted = stop;
+        return stop;
+    }
+
+    // the steps of the random walk of the phase
+    void walked(unsigned int const& steps)
+    {
+        if (progress != NULL) progress->add_steps(steps);
+    }
+
+    AnytimeVolume<NT>* progress;
+    int phase;
+    bool interrupted;
+};
+
 template
 <
     typename Point,
     typename ball,
     typename PolyBall2,
     typename NT,
-    typename RNG
+    typename RNG,
+    typename Observer = no_ratio_observer
 >
 NT estimate_ratio_interval(ball const& B,
                            PolyBall2 &Pb2,
@@ -619,7 +691,8 @@ NT estimate_ratio_interval(ball const& B,
                            int const& W,
                            int const& Ntot,
                            NT const& prob,
-                           RNG& rng)
+                           RNG& rng,
+                           Observer&& observer = Observer())
 {
     estimate_ratio_interval_parameters<NT> ratio_parameters(W, Ntot, ratio);
     boost::math::normal dist(0.0, 1.0);
@@ -639,7 +712,8 @@ NT estimate_ratio_interval(ball const& B,
 
     do {
         p = GetPointInDsphere<Point>::apply(n, radius, rng);
-    } while (!estimate_ratio_interval_generic(Pb2, p, error, zp, ratio_parameters));
+    } while (!estimate_ratio_interval_generic(Pb2, p, error, zp, ratio_parameters)
+             && !observer(ratio_parameters));
 
     return NT(ratio_parameters.count_in) / NT(ratio_parameters.tot_count);
 }
@@ -652,7 +726,8 @@ template
         typename PolyBall1,
         typename PolyBall2,
         typename NT,
-        typename RNG
+        typename RNG,
+        typename Observer = no_ratio_observer
 >
 NT estimate_ratio_interval(PolyBall1 &Pb1,
                            PolyBall2 &Pb2,
@@ -662,7 +737,9 @@ NT estimate_ratio_interval(PolyBall1 &Pb1,
                            int const& Ntot,
                            NT const& prob,
                            unsigned int const& walk_length,
-                           RNG& rng)
+                           RNG& rng,
+                           Observer&& observer = Observer(),
+                           recycled_samples<Point>* samples = NULL)
 {
     estimate_ratio_interval_parameters<NT> ratio_parameters(W, Ntot, ratio);
     boost::math::normal dist(0.0, 1.0);
@@ -670,11 +747,36 @@ NT estimate_ratio_interval(PolyBall1 &Pb1,
 
     unsigned int n = Pb1.dimension();
     Point p(n);
+    int filled = 0;
+
+    // the sample of the schedule replaces the prior, which counts the same points,
+    // if it is long enough for the window to miss the noisy first estimates
+    if (samples != NULL && samples->schedule.size() >= 2 * std::size_t(W))
+    {
+        ratio_parameters.tot_count = 0;
+        ratio_parameters.count_in = 0;
+        std::size_t skip = samples->schedule.size() - W;
+        for (Point const& q : samples->schedule)
+        {
+            if (skip > 0)
+            {
+                if (Pb2.is_in(q) == -1) ratio_parameters.count_in++;
+                ratio_parameters.tot_count++;
+                skip--;
+                continue;
+            }
+            full_sliding_window(Pb2, q, ratio_parameters);
+            filled++;
+        }
+    }
+    if (samples != NULL && !samples->schedule.empty()) p = samples->schedule.back();
+
     WalkType walk(Pb1, p, rng);
 
-    for (int i = 0; i < ratio_parameters.W; ++i)
+    for (int i = filled; i < ratio_parameters.W; ++i)
     {
         walk.apply(Pb1, p, walk_length, rng);
+        observer.walked(walk_length);
         full_sliding_window(Pb2, p, ratio_parameters);
     }
 
@@ -682,11 +784,111 @@ NT estimate_ratio_interval(PolyBall1 &Pb1,
 
     do {
         walk.apply(Pb1, p, walk_length, rng);
-    } while (!estimate_ratio_interval_generic(Pb2, p, error, zp, ratio_parameters));
+        observer.walked(walk_length);
+    } while (!estimate_ratio_interval_generic(Pb2, p, error, zp, ratio_parameters)
+             && !observer(ratio_parameters));
 
     return NT(ratio_parameters.count_in) / NT(ratio_parameters.tot_count);
 }
 
+// estimate the logarithm of the i-th ratio of the schedule, i.e.
+// i = 0: vol(P \cap B_{m-1}) / vol(B_{m-1}),
+// i = 1: vol(P \cap B_0) / vol(P) (skipped if B_0 contains P),
+// i > 1: vol(P \cap B_{i-1}) / vol(P \cap B_{i-2})
+// every phase only reads P, the balls and the ratios, thus phases are independent;
+// the observer sees the running estimate of the phase and may stop it
+template
+<
+    typename WalkType,
+    typename Point,
+    typename PolyBall,
+    typename Polytope,
+    typename BallType,
+    typename NT,
+    typename RNG,
+    typename Observer = no_ratio_observer
+>
+NT estimate_log_ratio_of_phase(Polytope &P,
+                               std::vector<BallType> &BallSet,
+                               std::vector<NT> const& ratios,
+                               int const& i,
+                               NT const& er0,
+                               NT const& er1,
+                               NT const& prob,
+                               int const& N_times_nu,
+                               unsigned int const& walk_length,
+                               cooling_ball_parameters<NT> const& parameters,
+                               RNG& rng,
+                               Observer&& observer = Observer(),
+                               recycled_samples<Point>* samples = NULL)
+{
+    if (i == 0)
+    {
+        return (parameters.window2) ?
+                std::log(estimate_ratio<Point>(*(BallSet.end() - 1),
+                                               P, *(ratios.end() - 1),
+                                               er0, parameters.win_len, 1200, rng))
+              : std::log(estimate_ratio_interval<Point>(*(BallSet.end() - 1),
+                                                        P, *(ratios.end() - 1),
+                                                        er0, parameters.win_len, 1200,
+                                                        prob, rng, observer));
+    }
+
+    auto balliter = BallSet.begin();
+    auto ratioiter = ratios.begin();
+
+    if (i == 1)
+    {
+        if (*ratioiter == 1) return NT(0);
+
+        return (!parameters.window2) ?
+               std::log(NT(1) / estimate_ratio_interval
+                    <WalkType, Point>(P,
+                                      *balliter,
+                                      *ratioiter,
+                                      er1,
+                                      parameters.win_len,
+                                      N_times_nu,
+                                      prob,
+                                      walk_length,
+                                      rng,
+                                      observer,
+                                      samples))
+            : std::log(NT(1) / estimate_ratio
+                    <WalkType, Point>(P,
+                                      *balliter,
+                                      *ratioiter,
+                                      er1,
+                                      parameters.win_len,
+                                      N_times_nu,
+                                      walk_length,
+                                      rng));
+    }
+
+    balliter += i - 2;
+    ratioiter += i - 2;
+
+    PolyBall Pb(P, *balliter);
+    return (!parameters.window2) ?
+                std::log(NT(1) / estimate_ratio_interval
+                            <WalkType, Point>(Pb,
+                                              *(balliter + 1),
+                                              *(ratioiter + 1),
+                                              er1, parameters.win_len,
+                                              N_times_nu,
+                                              prob, walk_length,
+                                              rng, observer, samples))
+              : std::log(NT(1) / estimate_ratio
+                            <WalkType, Point>(Pb,
+                                              *balliter,
+                                              *ratioiter,
+                                              er1,
+                                              parameters.win_len,
+                                              N_times_nu,
+                                              walk_length,
+                                              rng));
+}
+
 template
 <
     typename WalkTypePolicy,
@@ -698,7 +900,12 @@ std::pair<double, double> volume_cooling_balls(Polytope& Pin,
                                                RandomNumberGenerator &rng,
                                                double const& error = 0.1,
                                                unsigned int const& walk_length = 1,
-                                               unsigned int const& win_len = 300)
+                                               unsigned int const& win_len = 300,
+                                               unsigned int const& num_threads = 1,
+                                               VolumeCheckpointer<double>* checkpointer = NULL,
+                                               AnnealingScheduleCache<typename Polytope::NT>* schedule_cache = NULL,
+                                               AnytimeVolume<double>* progress = NULL,
+                                               std::string const& walk_name = std::string())
 {
     typedef typename Polytope::PointType Point;
     typedef typename Point::FT NT;
@@ -729,20 +936,68 @@ std::pair<double, double> volume_cooling_balls(Polytope& Pin,
 
     std::vector<BallType> BallSet;
     std::vector<NT> ratios;
+    // the samples of the schedule, the i-th one is recycled by the (i+1)-th phase;
+    // they are not recycled when a run may be resumed, so that the resumed run
+    // continues exactly as the interrupted one
+    std::vector<PointList> schedule_samples;
+    const bool recycle = (checkpointer == NULL);
 
     // move the chebychev center to the origin
     // and apply the same shifting to the polytope
     P.shift(c.getCoefficients());
 
-    if ( !get_sequence_of_polytopeballs
-          <
-            RandomPointGenerator,
-            PolyBall
-          >(P, BallSet, ratios,
-            N_times_nu, radius, walk_length,
-            parameters, rng) )
+    bool resumed = (checkpointer != NULL)
+                   && checkpointer->resume(checkpoint_cooling_balls, n, polytope_fingerprint(Pin));
+    if (resumed)
     {
-        return std::pair<NT, NT> (-1.0, 0.0);
+        // the balls are centered at the origin, so the schedule is given by the radii;
+        // there is one more ratio than balls, the one of the first ball
+        volume_checkpoint<double> &state = checkpointer->state();
+        for (std::size_t j = 0; j < state.schedule.size(); ++j)
+        {
+            BallSet.push_back(BallType(Point(n), NT(state.schedule[j])));
+        }
+        ratios.assign(state.schedule_ratios.begin(), state.schedule_ratios.end());
+        checkpointer->restore_rng(rng);
+    } else {
+        // the schedule does not depend on the error, so it is shared by all the errors;
+        // it is stored under the name of the walk, thus it is not cached without a name
+        std::uint64_t key = 0;
+        std::vector<NT> cached_radii, cached_ratios;
+        if (walk_name.empty()) schedule_cache = NULL;
+        if (schedule_cache != NULL)
+        {
+            key = AnnealingScheduleCache<NT>::key(P, std::string("cooling_balls"), walk_name,
+                                                  walk_length, parameters.lb,
+                                                  parameters.ub, N_times_nu);
+        }
+        if (schedule_cache != NULL && schedule_cache->find(key, cached_radii, cached_ratios))
+        {
+            for (std::size_t j = 0; j < cached_radii.size(); ++j)
+            {
+                BallSet.push_back(BallType(Point(n), cached_radii[j]));
+            }
+            ratios = cached_ratios;
+        } else {
+            if ( !get_sequence_of_polytopeballs
+                  <
+                    RandomPointGenerator,
+                    PolyBall
+                  >(P, BallSet, ratios,
+                    N_times_nu, radius, walk_length,
+                    parameters, rng, recycle ? &schedule_samples : NULL) )
+            {
+                return std::pair<NT, NT> (-1.0, 0.0);
+            }
+            if (schedule_cache != NULL)
+            {
+                for (std::size_t j = 0; j < BallSet.size(); ++j)
+                {
+                    cached_radii.push_back(BallSet[j].squared_radius());
+                }
+                schedule_cache->insert(key, cached_radii, ratios);
+            }
+        }
     }
 
     NT vol = (NT(n)/NT(2) * std::log(M_PI)) + NT(n)*std::log((*(BallSet.end() - 1)).radius()) - log_gamma_function(NT(n) / NT(2) + 1);
@@ -752,64 +1007,160 @@ std::pair<double, double> volume_cooling_balls(Polytope& Pin,
     NT er0 = error / (2.0 * std::sqrt(NT(mm)));
     NT er1 = (error * std::sqrt(4.0 * NT(mm) - 1)) / (2.0 * std::sqrt(NT(mm)));
 
-    vol += (parameters.window2) ?
-                std::log(estimate_ratio<Point>(*(BallSet.end() - 1),
-                                               P, *(ratios.end() - 1),
-                                               er0, parameters.win_len, 1200, rng))
-              : std::log(estimate_ratio_interval<Point>(*(BallSet.end() - 1),
-                                                        P, *(ratios.end() - 1),
-                                                        er0, parameters.win_len, 1200,
-                                                        prob, rng));
-    auto balliter = BallSet.begin();
-    auto ratioiter = ratios.begin();
-
     er1 = er1 / std::sqrt(NT(mm) - 1.0);
 
-    if (*ratioiter != 1)
+    // the schedule is the most expensive part to recompute, so it is always saved
+    if (checkpointer != NULL && !resumed)
     {
-        vol += (!parameters.window2) ?
-               std::log(NT(1) / estimate_ratio_interval
-                    <WalkType, Point>(P,
-                                      *balliter,
-                                      *ratioiter,
-                                      er1,
-                                      parameters.win_len,
-                                      N_times_nu,
-                                      prob,
-                                      walk_length,
-                                      rng))
-            : std::log(NT(1) / estimate_ratio
-                    <WalkType, Point>(P,
-                                      *balliter,
-                                      *ratioiter,
-                                      er1,
-                                      parameters.win_len,
-                                      N_times_nu,
-                                      walk_length,
-                                      rng));
+        volume_checkpoint<double> &state = checkpointer->state();
+        for (std::size_t j = 0; j < BallSet.size(); ++j)
+        {
+            state.schedule.push_back(BallSet[j].squared_radius());
+        }
+        state.schedule_ratios.assign(ratios.begin(), ratios.end());
+        state.schedule_done = 1;
+        state.phase_done.assign(mm, 0);
+        state.phase_values.assign(mm, 0.0);
+        checkpointer->save(rng);
     }
 
-    for ( ; balliter < BallSet.end() - 1; ++balliter, ++ratioiter)
+    // the phases that a resumed run has already estimated
+    auto phase_done = [&](int i) {
+        return checkpointer != NULL && checkpointer->state().phase_done[i] != 0;
+    };
+    // the concurrent phases do not use rng, so they save without reseeding it
+    auto record_phase = [&](int i, NT log_ratio, bool reseed) {
+        if (checkpointer == NULL) return;
+        checkpointer->state().phase_done[i] = 1;
+        checkpointer->state().phase_values[i] = log_ratio;
+        if (!checkpointer->due()) return;
+        if (reseed) {
+            checkpointer->save(rng);
+        } else {
+            checkpointer->save();
+        }
+    };
+
+    // Until a phase is estimated, the anytime estimate uses the ratio of the schedule;
+    // its log has variance (1-r)/(rN) by the delta method, N the sample of the schedule.
+    // An estimated phase is within its error er with probability prob, the confidence
+    // of a phase, thus the standard deviation of its log is about er/zp
+    NT zp = NT(0);
+    if (progress != NULL)
     {
-        PolyBall Pb(P, *balliter);
-        vol += (!parameters.window2) ?
-                    std::log(NT(1) / estimate_ratio_interval
-                                <WalkType, Point>(Pb,
-                                                  *(balliter + 1),
-                                                  *(ratioiter + 1),
-                                                  er1, parameters.win_len,
-                                                  N_times_nu,
-                                                  prob, walk_length,
-                                                  rng))
-                  : std::log(NT(1) / estimate_ratio
-                                <WalkType, Point>(Pb,
-                                                  *balliter,
-                                                  *ratioiter,
-                                                  er1,
-                                                  parameters.win_len,
-                                                  N_times_nu,
-                                                  walk_length,
-                                                  rng));
+        boost::math::normal dist(0.0, 1.0);
+        zp = boost::math::quantile(boost::math::complement(dist, (1.0 - prob)/2.0));
+        std::vector<NT> log_ratios(mm), variances(mm);
+        for (int i = 0; i < mm; ++i)
+        {
+            NT r = (i == 0) ? *(ratios.end() - 1) : ratios[i - 1];
+            log_ratios[i] = (i == 0) ? std::log(r) : -std::log(r);
+            variances[i] = (NT(1) - r) / (r * NT(N_times_nu));
+        }
+        progress->start(vol, log_ratios, variances);
+    }
+    auto stopped = [&]() {
+        return progress != NULL && progress->stopped();
+    };
+    auto report_phase = [&](int i, NT log_ratio) {
+        if (progress == NULL) return;
+        NT sd = ((i == 0) ? er0 : er1) / zp;
+        if (i == 1 && ratios[0] == 1) sd = NT(0);
+        #pragma omp critical(anytime_volume)
+        progress->update(i, log_ratio, sd * sd, true);
+    };
+
+    auto recycle_schedule = [&](int i, recycled_samples<Point> &samples) {
+        if (i >= 1 && std::size_t(i - 1) < schedule_samples.size())
+        {
+            samples.schedule.swap(schedule_samples[i - 1]);
+        }
+    };
+
+    if (num_threads <= 1)
+    {
+        for (int i = 0; i < mm; ++i)
+        {
+            recycled_samples<Point> samples;
+            if (phase_done(i))
+            {
+                report_phase(i, checkpointer->state().phase_values[i]);
+                vol += checkpointer->state().phase_values[i];
+                continue;
+            }
+            // after an early stop the remaining phases keep their anytime estimate
+            if (stopped())
+            {
+                vol += progress->log_ratio(i);
+                continue;
+            }
+            recycle_schedule(i, samples);
+            anytime_phase_observer<NT> observer(progress, i);
+            NT log_ratio = estimate_log_ratio_of_phase<WalkType, Point, PolyBall>
+                            (P, BallSet, ratios, i, er0, er1, prob, N_times_nu,
+                             walk_length, parameters, rng, observer, &samples);
+            if (observer.interrupted)
+            {
+                vol += progress->log_ratio(i);
+                continue;
+            }
+            record_phase(i, log_ratio, true);
+            report_phase(i, log_ratio);
+            vol += log_ratio;
+        }
+    } else {
+        // estimate all the ratios concurrently; each phase uses its own copy of P
+        // and its own random stream, seeded by rng, so the estimation does not
+        // depend on the number of threads. The saves keep the seed of rng that is
+        // stored with the schedule, thus a resumed run draws the same seeds
+        std::vector<unsigned int> seeds(mm);
+        for (int i = 0; i < mm; ++i)
+        {
+            seeds[i] = (unsigned int)(rng.sample_urdist()
+                                      * NT(std::numeric_limits<unsigned int>::max()));
+        }
+        std::vector<NT> log_ratios(mm, NT(0));
+        // an exception must not leave the parallel region, it is thrown after the loop
+        std::exception_ptr save_error;
+
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+        for (int i = 0; i < mm; ++i)
+        {
+            if (phase_done(i))
+            {
+                log_ratios[i] = checkpointer->state().phase_values[i];
+                report_phase(i, log_ratios[i]);
+                continue;
+            }
+            if (stopped()) continue;
+            Polytope P_i(P);
+            RandomNumberGenerator rng_i(rng);
+            rng_i.set_seed(seeds[i]);
+            recycled_samples<Point> samples;
+            recycle_schedule(i, samples);
+            anytime_phase_observer<NT> observer(progress, i);
+            log_ratios[i] = estimate_log_ratio_of_phase<WalkType, Point, PolyBall>
+                                (P_i, BallSet, ratios, i, er0, er1, prob, N_times_nu,
+                                 walk_length, parameters, rng_i, observer, &samples);
+            if (observer.interrupted) continue;
+            #pragma omp critical
+            {
+                try {
+                    record_phase(i, log_ratios[i], false);
+                } catch (...) {
+                    if (!save_error) save_error = std::current_exception();
+                }
+            }
+            report_phase(i, log_ratios[i]);
+        }
+        if (save_error) std::rethrow_exception(save_error);
+
+        // the phases that an early stop interrupted or skipped keep their anytime estimate
+        if (stopped())
+        {
+            for (int i = 0; i < mm; ++i) log_ratios[i] = progress->log_ratio(i);
+        }
+        for (int i = 0; i < mm; ++i) vol += log_ratios[i];
     }
 
     return std::pair<NT, NT> (vol, std::exp(vol));
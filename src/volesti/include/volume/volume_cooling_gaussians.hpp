@@ -12,11 +12,14 @@
 
 //#define VOLESTI_DEBUG
 
+#include <algorithm>
 #include <iterator>
+#include <limits>
 #include <vector>
 #include <list>
 #include <math.h>
 #include <chrono>
+#include <string>
 
 #include "cartesian_geom/cartesian_kernel.h"
 #include "random_walks/gaussian_helpers.hpp"
@@ -24,6 +27,8 @@
 #include "random_walks/gaussian_cdhr_walk.hpp"
 #include "sampling/random_point_generators.hpp"
 #include "volume/math_helpers.hpp"
+#include "volume/volume_checkpoint.hpp"
+#include "volume/annealing_schedule_cache.hpp"
 
 
 /////////////////// Helpers for random walks
@@ -47,6 +52,139 @@ struct update_delta<GaussianBallWalk::Walk<Polytope, RandomNumberGenerator>>
 };
 
 
+/// Independent chains used by the multithreaded version of the algorithm.
+/// Every chain has its own copy of the polytope, its own point and its own
+/// random number generator, seeded by the generator of the caller
+template <typename Polytope, typename RandomNumberGenerator>
+struct gaussian_annealing_chains
+{
+    typedef typename Polytope::PointType Point;
+    typedef typename Point::FT NT;
+
+    gaussian_annealing_chains(Polytope const& P,
+                              Point const& p,
+                              unsigned int const& num_chains,
+                              RandomNumberGenerator& rng)
+    {
+        polytopes.reserve(num_chains);
+        rngs.reserve(num_chains);
+        for (unsigned int t = 0; t < num_chains; ++t)
+        {
+            polytopes.push_back(P);
+            points.push_back(p);
+            rngs.push_back(rng);
+        }
+        reseed(rng);
+    }
+
+    void reseed(RandomNumberGenerator& rng)
+    {
+        for (unsigned int t = 0; t < rngs.size(); ++t)
+        {
+            rngs[t].set_seed((unsigned int)(rng.sample_urdist()
+                             * NT(std::numeric_limits<unsigned int>::max())));
+        }
+    }
+
+    unsigned int size() const
+    {
+        return polytopes.size();
+    }
+
+    std::vector<Polytope> polytopes;
+    std::vector<Point> points;
+    std::vector<RandomNumberGenerator> rngs;
+};
+
+
+/// The sliding window of the last W values of a ratio estimator.
+/// The estimation has converged when (max - min) / max <= eps / 2 in the window
+template <typename NT>
+struct gaussian_ratio_window
+{
+    gaussian_ratio_window(unsigned int const& W_len)
+        :   W(W_len)
+        ,   min_val(std::numeric_limits<NT>::min())
+        ,   max_val(std::numeric_limits<NT>::max())
+        ,   min_index(W_len - 1)
+        ,   max_index(W_len - 1)
+        ,   index(0)
+        ,   last_W(std::vector<NT>(W_len, 0))
+    {}
+
+    // add the current value of the estimator, return true if it has converged
+    bool update(NT const& val, NT const& curr_eps)
+    {
+        typename std::vector<NT>::iterator minmaxIt;
+        bool done = false;
+
+        last_W[index] = val;
+        if (val <= min_val)
+        {
+            min_val = val;
+            min_index = index;
+        } else if (min_index == index)
+        {
+            minmaxIt = std::min_element(last_W.begin(), last_W.end());
+            min_val = *minmaxIt;
+            min_index = std::distance(last_W.begin(), minmaxIt);
+        }
+
+        if (val >= max_val)
+        {
+            max_val = val;
+            max_index = index;
+        } else if (max_index == index)
+        {
+            minmaxIt = std::max_element(last_W.begin(), last_W.end());
+            max_val = *minmaxIt;
+            max_index = std::distance(last_W.begin(), minmaxIt);
+        }
+
+        if ( (max_val-min_val)/max_val <= curr_eps/2.0 )
+        {
+            done=true;
+        }
+
+        index = index%W + 1;
+        if (index == W) index = 0;
+
+        return done;
+    }
+
+    // the window as a vector of values, it is stored in the checkpoints
+    template <typename VNT>
+    void get_state(std::vector<VNT> &state) const
+    {
+        state.push_back(min_val);
+        state.push_back(max_val);
+        state.push_back(min_index);
+        state.push_back(max_index);
+        state.push_back(index);
+        state.insert(state.end(), last_W.begin(), last_W.end());
+    }
+
+    template <typename Iterator>
+    void set_state(Iterator it)
+    {
+        min_val = *it++;
+        max_val = *it++;
+        min_index = (unsigned int)(*it++);
+        max_index = (unsigned int)(*it++);
+        index = (unsigned int)(*it++);
+        std::copy(it, it + W, last_W.begin());
+    }
+
+    unsigned int W;
+    NT min_val;
+    NT max_val;
+    unsigned int min_index;
+    unsigned int max_index;
+    unsigned int index;
+    std::vector<NT> last_W;
+};
+
+
 ////////////////////////////// Algorithms
 
 // Gaussian Anealling
@@ -55,18 +193,17 @@ struct update_delta<GaussianBallWalk::Walk<Polytope, RandomNumberGenerator>>
 // Springer-Verlag Berlin Heidelberg and The Mathematical Programming Society 2015
 // Ben Cousins, Santosh Vempala
 
-// Compute the first variance a_0 for the starting gaussian
-template <typename Polytope, typename NT>
-void get_first_gaussian(Polytope& P,
+// Compute the first variance a_0 for the starting gaussian, given the distances
+// of its center to the facets of the polytope
+template <typename NT>
+void get_first_gaussian(std::vector<NT> const& dists,
                         NT const& frac,
-                        NT const& chebychev_radius,
                         NT const& error,
                         std::vector<NT> & a_vals)
 {
     // if tol is smaller than 1e-6 no convergence can be obtained when float is used
     NT tol = std::is_same<float, NT>::value ? 0.001 : 0.0000001;
 
-    std::vector <NT> dists = P.get_dists(chebychev_radius);
     NT lower = 0.0;
     NT upper = 1.0;
 
@@ -115,26 +252,25 @@ void get_first_gaussian(Polytope& P,
     a_vals.push_back((upper + lower) / NT(2.0));
 }
 
+template <typename Polytope, typename NT>
+void get_first_gaussian(Polytope& P,
+                        NT const& frac,
+                        NT const& chebychev_radius,
+                        NT const& error,
+                        std::vector<NT> & a_vals)
+{
+    get_first_gaussian(P.get_dists(chebychev_radius), frac, error, a_vals);
+}
 
-// Compute a_{i+1} when a_i is given
-template
-<
-    typename RandomPointGenerator,
-    typename Polytope,
-    typename Point,
-    typename NT,
-    typename RandomNumberGenerator
->
-NT get_next_gaussian(Polytope& P,
-                     Point &p,
+
+// Compute a_{i+1} from N points sampled from the gaussian with variance a_i
+template <typename PointList, typename NT>
+NT get_next_gaussian(PointList const& randPoints,
                      NT const& a,
                      const unsigned int &N,
                      const NT &ratio,
-                     const NT &C,
-                     const unsigned int& walk_length,
-                     RandomNumberGenerator& rng)
+                     const NT &C)
 {
-
     NT last_a = a;
     NT last_ratio = 0.1;
     //k is needed for the computation of the next variance a_{i+1} = a_i * (1-1/d)^k
@@ -142,13 +278,6 @@ NT get_next_gaussian(Polytope& P,
     const NT tol = 0.00001;
     bool done=false;
     std::vector<NT> fn(N,NT(0.0));
-    std::list<Point> randPoints;
-    typedef typename std::vector<NT>::iterator viterator;
-
-    //sample N points
-    PushBackWalkPolicy push_back_policy;
-    RandomPointGenerator::apply(P, p, last_a, N, walk_length, randPoints,
-                                push_back_policy, rng);
 
     while (!done)
     {
@@ -177,6 +306,71 @@ NT get_next_gaussian(Polytope& P,
     return last_a * std::pow(ratio, k);
 }
 
+// Compute a_{i+1} when a_i is given
+template
+<
+    typename RandomPointGenerator,
+    typename Polytope,
+    typename Point,
+    typename NT,
+    typename RandomNumberGenerator
+>
+NT get_next_gaussian(Polytope& P,
+                     Point &p,
+                     NT const& a,
+                     const unsigned int &N,
+                     const NT &ratio,
+                     const NT &C,
+                     const unsigned int& walk_length,
+                     RandomNumberGenerator& rng)
+{
+    std::list<Point> randPoints;
+
+    //sample N points
+    PushBackWalkPolicy push_back_policy;
+    RandomPointGenerator::apply(P, p, a, N, walk_length, randPoints,
+                                push_back_policy, rng);
+
+    return get_next_gaussian(randPoints, a, N, ratio, C);
+}
+
+// Compute a_{i+1} when a_i is given, the N points are sampled by all the chains in parallel
+template
+<
+    typename RandomPointGenerator,
+    typename Chains,
+    typename NT
+>
+NT get_next_gaussian(Chains& chains,
+                     NT const& a,
+                     const unsigned int &N,
+                     const NT &ratio,
+                     const NT &C,
+                     const unsigned int& walk_length)
+{
+    typedef typename Chains::Point Point;
+    const int num_chains = chains.size();
+    std::vector<std::list<Point>> chain_points(num_chains);
+
+    #pragma omp parallel for num_threads(num_chains)
+    for (int t = 0; t < num_chains; ++t)
+    {
+        unsigned int N_t = N / num_chains + ((unsigned int)(t) < N % num_chains ? 1 : 0);
+        PushBackWalkPolicy push_back_policy;
+        RandomPointGenerator::apply(chains.polytopes[t], chains.points[t], a, N_t,
+                                    walk_length, chain_points[t], push_back_policy,
+                                    chains.rngs[t]);
+    }
+
+    std::list<Point> randPoints;
+    for (int t = 0; t < num_chains; ++t)
+    {
+        randPoints.splice(randPoints.end(), chain_points[t]);
+    }
+
+    return get_next_gaussian(randPoints, a, N, ratio, C);
+}
+
 // Compute the sequence of spherical gaussians
 template
 <
@@ -195,13 +389,24 @@ void compute_annealing_schedule(Polytope& P,
                                 NT const& chebychev_radius,
                                 NT const& error,
                                 std::vector<NT>& a_vals,
-                                RandomNumberGenerator& rng)
+                                RandomNumberGenerator& rng,
+                                unsigned int const& num_threads = 1,
+                                VolumeCheckpointer<double>* checkpointer = NULL)
 {
     typedef typename Polytope::PointType Point;
     typedef typename Polytope::VT VT;
 
+    // a resumed run continues the schedule that is stored in the checkpoint
+    const bool resumed = (checkpointer != NULL) && !checkpointer->state().schedule.empty();
+
     // Compute the first gaussian
-    get_first_gaussian(P, frac, chebychev_radius, error, a_vals);
+    if (resumed)
+    {
+        a_vals.assign(checkpointer->state().schedule.begin(),
+                      checkpointer->state().schedule.end());
+    } else {
+        get_first_gaussian(P, frac, chebychev_radius, error, a_vals);
+    }
 
 #ifdef VOLESTI_DEBUG
     std::cout<<"first gaussian computed\n"<<std::endl;
@@ -209,7 +414,7 @@ void compute_annealing_schedule(Polytope& P,
 
     NT a_stop = 0.0;
     const NT tol = 0.001;
-    unsigned int it = 0;
+    unsigned int it = a_vals.size() - 1;
     unsigned int n = P.dimension();
     const unsigned int totalSteps = ((int)150/((1.0 - frac) * error))+1;
 
@@ -220,30 +425,73 @@ void compute_annealing_schedule(Polytope& P,
 #endif
 
     Point p(n);
+    if (resumed)
+    {
+        std::vector<Point> stored(1, p);
+        restore_points(checkpointer->state(), stored);
+        p = stored[0];
+        checkpointer->restore_rng(rng);
+    }
+
+    // the chains of the multithreaded version, there are none for a single thread
+    const int num_chains = (num_threads > 1) ? num_threads : 0;
+    gaussian_annealing_chains<Polytope, RandomNumberGenerator> chains(P, p, num_chains, rng);
+    if (resumed) restore_points(checkpointer->state(), chains.points);
 
     while (true)
     {
         // Compute the next gaussian
-        NT next_a = get_next_gaussian<RandomPointGenerator>
-                      (P, p, a_vals[it], N, ratio, C, walk_length, rng);
+        NT next_a = (num_chains > 0) ?
+                      get_next_gaussian<RandomPointGenerator>
+                        (chains, a_vals[it], N, ratio, C, walk_length)
+                    : get_next_gaussian<RandomPointGenerator>
+                        (P, p, a_vals[it], N, ratio, C, walk_length, rng);
 
         NT curr_fn = 0;
         NT curr_its = 0;
         auto steps = totalSteps;
 
-        WalkType walk(P, p, a_vals[it], rng);
-        //TODO: test update delta here?
+        if (num_chains > 0)
+        {
+            // split the steps among the chains
+            std::vector<NT> chain_fn(num_chains, NT(0));
 
-        update_delta<WalkType>
-                ::apply(walk, 4.0 * chebychev_radius
-                        / std::sqrt(std::max(NT(1.0), a_vals[it]) * NT(n)));
+            #pragma omp parallel for num_threads(num_chains)
+            for (int t = 0; t < num_chains; ++t)
+            {
+                Point &q = chains.points[t];
+                WalkType walk(chains.polytopes[t], q, a_vals[it], chains.rngs[t]);
+
+                update_delta<WalkType>
+                        ::apply(walk, 4.0 * chebychev_radius
+                                / std::sqrt(std::max(NT(1.0), a_vals[it]) * NT(n)));
+
+                unsigned int steps_t = steps / num_chains
+                                     + ((unsigned int)(t) < steps % num_chains ? 1 : 0);
+                for (unsigned int j = 0; j < steps_t; j++)
+                {
+                    walk.apply(chains.polytopes[t], q, a_vals[it], walk_length, chains.rngs[t]);
+                    chain_fn[t] += eval_exp(q, next_a) / eval_exp(q, a_vals[it]);
+                }
+            }
 
-        // Compute some ratios to decide if this is the last gaussian
-        for (unsigned  int j = 0; j < steps; j++)
-        {
-            walk.apply(P, p, a_vals[it], walk_length, rng);
-            curr_its += 1.0;
-            curr_fn += eval_exp(p, next_a) / eval_exp(p, a_vals[it]);
+            for (int t = 0; t < num_chains; ++t) curr_fn += chain_fn[t];
+            curr_its = NT(steps);
+        } else {
+            WalkType walk(P, p, a_vals[it], rng);
+            //TODO: test update delta here?
+
+            update_delta<WalkType>
+                    ::apply(walk, 4.0 * chebychev_radius
+                            / std::sqrt(std::max(NT(1.0), a_vals[it]) * NT(n)));
+
+            // Compute some ratios to decide if this is the last gaussian
+            for (unsigned  int j = 0; j < steps; j++)
+            {
+                walk.apply(P, p, a_vals[it], walk_length, rng);
+                curr_its += 1.0;
+                curr_fn += eval_exp(p, next_a) / eval_exp(p, a_vals[it]);
+            }
         }
 
         // Remove the last gaussian.
@@ -252,6 +500,15 @@ void compute_annealing_schedule(Polytope& P,
         {
             a_vals.push_back(next_a);
             it++;
+
+            if (checkpointer != NULL && checkpointer->due())
+            {
+                checkpointer->state().schedule.assign(a_vals.begin(), a_vals.end());
+                store_points(checkpointer->state(),
+                             (num_chains > 0) ? chains.points : std::vector<Point>(1, p));
+                checkpointer->save(rng);
+                chains.reseed(rng);
+            }
         } else if (next_a <= 0)
         {
             a_vals.push_back(a_stop);
@@ -292,7 +549,11 @@ template
 double volume_cooling_gaussians(Polytope& Pin,
                                 RandomNumberGenerator& rng,
                                 double const& error = 0.1,
-                                unsigned int const& walk_length = 1)
+                                unsigned int const& walk_length = 1,
+                                unsigned int const& num_threads = 1,
+                                VolumeCheckpointer<double>* checkpointer = NULL,
+                                AnnealingScheduleCache<typename Polytope::NT>* schedule_cache = NULL,
+                                std::string const& walk_name = std::string())
 {
     typedef typename Polytope::PointType Point;
     typedef typename Point::FT NT;
@@ -335,11 +596,44 @@ double volume_cooling_gaussians(Polytope& Pin,
     NT C = parameters.C;
     unsigned int N = parameters.N;
 
-    compute_annealing_schedule
-    <
-        WalkType,
-        RandomPointGenerator
-    >(P, ratio, C, parameters.frac, N, walk_length, radius, error, a_vals, rng);
+    const bool resumed = (checkpointer != NULL)
+                         && checkpointer->resume(checkpoint_cooling_gaussians, n,
+                                                              polytope_fingerprint(Pin));
+
+    if (resumed && checkpointer->state().schedule_done)
+    {
+        a_vals.assign(checkpointer->state().schedule.begin(),
+                      checkpointer->state().schedule.end());
+        checkpointer->restore_rng(rng);
+    } else {
+        std::uint64_t key = 0;
+        std::vector<NT> cached_a_vals, unused;
+        // a partial schedule of a checkpoint is completed, it is not looked up;
+        // the schedules are stored under the name of the walk, so it is required
+        const bool use_cache = (schedule_cache != NULL) && !walk_name.empty()
+                               && (!resumed || checkpointer->state().schedule.empty());
+        if (use_cache)
+        {
+            key = AnnealingScheduleCache<NT>::key(P, std::string("cooling_gaussians"), walk_name,
+                                                  error, walk_length, N, ratio, C,
+                                                  parameters.frac);
+        }
+        if (use_cache && schedule_cache->find(key, cached_a_vals, unused))
+        {
+            a_vals = cached_a_vals;
+        } else {
+            compute_annealing_schedule
+            <
+                WalkType,
+                RandomPointGenerator
+            >(P, ratio, C, parameters.frac, N, walk_length, radius, error, a_vals, rng,
+              num_threads, checkpointer);
+            if (use_cache)
+            {
+                schedule_cache->insert(key, a_vals);
+            }
+        }
+    }
 
 #ifdef VOLESTI_DEBUG
     std::cout<<"All the variances of schedule_annealing computed in = "
@@ -354,7 +648,6 @@ double volume_cooling_gaussians(Polytope& Pin,
     // Initialization for the approximation of the ratios
     unsigned int W = parameters.W;
     unsigned int mm = a_vals.size()-1;
-    std::vector<NT> last_W2(W,0);
     std::vector<NT> fn(mm,0);
     std::vector<NT> its(mm,0);
     VT lamdas;
@@ -363,16 +656,65 @@ double volume_cooling_gaussians(Polytope& Pin,
     Point p(n); // The origin is the Chebychev center of the Polytope
     unsigned int i=0;
 
+    // the schedule is always saved, the phases are saved when the interval elapses
+    if (checkpointer != NULL && !checkpointer->state().schedule_done)
+    {
+        volume_checkpoint<double> &state = checkpointer->state();
+        state.schedule.assign(a_vals.begin(), a_vals.end());
+        state.schedule_done = 1;
+        state.phase_done.assign(mm, 0);
+        state.phase_values.assign(2 * mm, 0.0);
+        state.window.clear();
+        state.points.clear();
+        checkpointer->save(rng);
+    }
+
     typedef typename std::vector<NT>::iterator viterator;
     viterator itsIt = its.begin();
     viterator avalsIt = a_vals.begin();
-    viterator minmaxIt;
 
 #ifdef VOLESTI_DEBUG
     std::cout<<"volume of the first gaussian = "<<vol<<"\n"<<std::endl;
     std::cout<<"computing ratios..\n"<<std::endl;
 #endif
 
+    // the chains of the multithreaded version, there are none for a single thread
+    const int num_chains = (num_threads > 1) ? num_threads : 0;
+    gaussian_annealing_chains<Polytope, RandomNumberGenerator> chains(P, p, num_chains, rng);
+    // number of steps that every chain performs before the window is updated
+    const unsigned int batch = (num_chains > 0) ? std::max(1u, W / (10 * num_chains)) : 0;
+
+    if (checkpointer != NULL)
+    {
+        std::vector<Point> stored(1, p);
+        restore_points(checkpointer->state(), stored);
+        p = stored[0];
+        restore_points(checkpointer->state(), chains.points);
+    }
+
+    // store the estimator of the i-th ratio, the window is NULL if it has converged
+    auto store_phase = [&](unsigned int i, NT const& fn_i, NT const& its_i,
+                           gaussian_ratio_window<NT> const* window) {
+        volume_checkpoint<double> &state = checkpointer->state();
+        state.window.clear();
+        if (window != NULL)
+        {
+            state.window.push_back(fn_i);
+            state.window.push_back(its_i);
+            window->get_state(state.window);
+        } else {
+            state.phase_done[i] = 1;
+            state.phase_values[2 * i] = fn_i;
+            state.phase_values[2 * i + 1] = its_i;
+        }
+        store_points(state, (num_chains > 0) ? chains.points : std::vector<Point>(1, p));
+    };
+    // the caller restarts its walks after a save, as a resumed run does
+    auto save_checkpoint = [&]() {
+        checkpointer->save(rng);
+        chains.reseed(rng);
+    };
+
     //iterate over the number of ratios
     for (viterator fnIt = fn.begin();
          fnIt != fn.end();
@@ -381,65 +723,123 @@ double volume_cooling_gaussians(Polytope& Pin,
         //initialize convergence test
         bool done = false;
         NT curr_eps = error/std::sqrt((NT(mm)));
-        NT min_val = std::numeric_limits<NT>::min();
-        NT max_val = std::numeric_limits<NT>::max();
-        unsigned int min_index = W-1;
-        unsigned int max_index = W-1;
-        unsigned int index = 0;
         unsigned int min_steps = 0;
-        std::vector<NT> last_W = last_W2;
-
-        // Set the radius for the ball walk
-        WalkType walk(P, p, *avalsIt, rng);
+        gaussian_ratio_window<NT> window(W);
 
-        update_delta<WalkType>
-                ::apply(walk, 4.0 * radius
-                         / std::sqrt(std::max(NT(1.0), *avalsIt) * NT(n)));
-
-        while (!done || (*itsIt)<min_steps)
+        if (checkpointer != NULL)
         {
-            walk.apply(P, p, *avalsIt, walk_length, rng);
-
-            *itsIt = *itsIt + 1.0;
-            *fnIt = *fnIt + eval_exp(p,*(avalsIt+1)) / eval_exp(p,*avalsIt);
-            NT val = (*fnIt) / (*itsIt);
-
-            last_W[index] = val;
-            if (val <= min_val)
+            volume_checkpoint<double> &state = checkpointer->state();
+            if (state.phase_done[i])
             {
-                min_val = val;
-                min_index = index;
-            } else if (min_index == index)
+                // the ratio has been estimated by the run that wrote the checkpoint
+                *fnIt = state.phase_values[2 * i];
+                *itsIt = state.phase_values[2 * i + 1];
+                vol *= ((*fnIt) / (*itsIt));
+                continue;
+            }
+            if (!state.window.empty())
             {
-                minmaxIt = std::min_element(last_W.begin(), last_W.end());
-                min_val = *minmaxIt;
-                min_index = std::distance(last_W.begin(), minmaxIt);
+                *fnIt = state.window[0];
+                *itsIt = state.window[1];
+                window.set_state(state.window.begin() + 2);
             }
+        }
 
-            if (val >= max_val)
-            {
-                max_val = val;
-                max_index = index;
-            } else if (max_index == index)
+        if (num_chains > 0)
+        {
+            // Every chain performs a batch of steps in parallel. Then the values are
+            // added to the common estimator and its window in a fixed order, so the
+            // chains never wait for each other inside a batch
+            std::vector<WalkType> walks;
+            walks.reserve(num_chains);
+            for (int t = 0; t < num_chains; ++t)
             {
-                minmaxIt = std::max_element(last_W.begin(), last_W.end());
-                max_val = *minmaxIt;
-                max_index = std::distance(last_W.begin(), minmaxIt);
+                walks.push_back(WalkType(chains.polytopes[t], chains.points[t],
+                                         *avalsIt, chains.rngs[t]));
+                update_delta<WalkType>
+                        ::apply(walks[t], 4.0 * radius
+                                 / std::sqrt(std::max(NT(1.0), *avalsIt) * NT(n)));
             }
+            std::vector<std::vector<NT>> chain_vals(num_chains, std::vector<NT>(batch));
 
-            if ( (max_val-min_val)/max_val <= curr_eps/2.0 )
+            while (!done || (*itsIt)<min_steps)
             {
-                done=true;
+                #pragma omp parallel for num_threads(num_chains)
+                for (int t = 0; t < num_chains; ++t)
+                {
+                    Point &q = chains.points[t];
+                    for (unsigned int j = 0; j < batch; ++j)
+                    {
+                        walks[t].apply(chains.polytopes[t], q, *avalsIt, walk_length,
+                                       chains.rngs[t]);
+                        chain_vals[t][j] = eval_exp(q,*(avalsIt+1)) / eval_exp(q,*avalsIt);
+                    }
+                }
+
+                for (unsigned int j = 0; j < batch && (!done || (*itsIt)<min_steps); ++j)
+                {
+                    for (int t = 0; t < num_chains && (!done || (*itsIt)<min_steps); ++t)
+                    {
+                        *itsIt = *itsIt + 1.0;
+                        *fnIt = *fnIt + chain_vals[t][j];
+                        done = window.update((*fnIt) / (*itsIt), curr_eps);
+                    }
+                }
+
+                if (checkpointer != NULL && !done && checkpointer->due())
+                {
+                    store_phase(i, *fnIt, *itsIt, &window);
+                    save_checkpoint();
+                    for (int t = 0; t < num_chains; ++t)
+                    {
+                        walks[t] = WalkType(chains.polytopes[t], chains.points[t],
+                                            *avalsIt, chains.rngs[t]);
+                        update_delta<WalkType>
+                                ::apply(walks[t], 4.0 * radius
+                                         / std::sqrt(std::max(NT(1.0), *avalsIt) * NT(n)));
+                    }
+                }
             }
+        } else {
+            // Set the radius for the ball walk
+            WalkType walk(P, p, *avalsIt, rng);
+
+            update_delta<WalkType>
+                    ::apply(walk, 4.0 * radius
+                             / std::sqrt(std::max(NT(1.0), *avalsIt) * NT(n)));
 
-            index = index%W + 1;
-            if (index == W) index = 0;
+            while (!done || (*itsIt)<min_steps)
+            {
+                walk.apply(P, p, *avalsIt, walk_length, rng);
+
+                *itsIt = *itsIt + 1.0;
+                *fnIt = *fnIt + eval_exp(p,*(avalsIt+1)) / eval_exp(p,*avalsIt);
+                NT val = (*fnIt) / (*itsIt);
+
+                if (window.update(val, curr_eps)) done = true;
+
+                if (checkpointer != NULL && !done && checkpointer->due())
+                {
+                    store_phase(i, *fnIt, *itsIt, &window);
+                    save_checkpoint();
+                    walk = WalkType(P, p, *avalsIt, rng);
+                    update_delta<WalkType>
+                            ::apply(walk, 4.0 * radius
+                                     / std::sqrt(std::max(NT(1.0), *avalsIt) * NT(n)));
+                }
+            }
         }
 #ifdef VOLESTI_DEBUG
         std::cout << "ratio " << i << " = " << (*fnIt) / (*itsIt)
                   << " N_" << i << " = " << *itsIt << std::endl;
 #endif
         vol *= ((*fnIt) / (*itsIt));
+
+        if (checkpointer != NULL)
+        {
+            store_phase(i, *fnIt, *itsIt, NULL);
+            if (checkpointer->due()) save_checkpoint();
+        }
     }
 
 #ifdef VOLESTI_DEBUG
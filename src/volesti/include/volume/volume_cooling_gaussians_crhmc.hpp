@@ -21,6 +21,23 @@
 #include "volume/volume_cooling_gaussians.hpp"
 #include "preprocess/crhmc/crhmc_problem.h"
 
+// Every walk of the annealing starts from the center of the problem with a small
+// step, that its tuner grows in the first steps. The chain hardly moves in those
+// steps, so they are discarded; otherwise the samples of the gaussian stay next to
+// the center and the ratios, as well as the variances of the schedule, are biased.
+template <typename CRHMCWalkType, typename RandomNumberGenerator>
+void warm_up_walk(CRHMCWalkType &walk,
+                  RandomNumberGenerator &rng,
+                  unsigned int const& walk_length)
+{
+    auto &step_size = walk.module_update->tune_step_size;
+    if (!step_size) return;
+    while (!step_size->warmupFinished && !walk.P.terminate)
+    {
+        walk.apply(rng, walk_length);
+    }
+}
+
 template
 <
     typename CRHMCWalkType,
@@ -96,35 +113,145 @@ NT get_next_gaussian(Polytope& P,
     return last_a * std::pow(ratio, k);
 }
 
+/// The CRHMC problem of the gaussians exp(-a||x||^2) of the annealing. The polytope
+/// is preprocessed once, with a = 0, so its presolve, scaling and center depend only
+/// on the constraints. The functors refer to params, thus every gaussian of the
+/// schedule and of the phases only sets its variance and starts a new walk.
+/// The center of the problem becomes the origin of the gaussians.
+/// \tparam Polytope HPolytope or constraint_problem
+/// \tparam Point Point type
+template <typename Polytope, typename Point>
+struct crhmc_gaussian_problem
+{
+    typedef typename Point::FT                                  NT;
+    typedef typename Polytope::MT                               MT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, 1>                VT;
+    typedef typename GaussianFunctor::FunctionFunctor<Point>    Func;
+    typedef typename GaussianFunctor::GradientFunctor<Point>    Grad;
+    typedef typename GaussianFunctor::HessianFunctor<Point>     Hess;
+    typedef typename GaussianFunctor::parameters<NT, Point>     func_params;
+    typedef crhmc_input<MT, Point, Func, Grad, Hess>            Input;
+    typedef crhmc_problem<Point, Input>                         CrhmcProblem;
+
+    func_params params;
+    Func f;
+    Grad g;
+    Hess h;
+    Input input;
+    CrhmcProblem problem;
+    VT shift;  // the center of the problem in the coordinates of the polytope
+
+    crhmc_gaussian_problem(Polytope &P, int const& simdLen)
+        :   params(Point(P.dimension()), NT(0), 1)
+        ,   f(params)
+        ,   g(params)
+        ,   h(params)
+        ,   input(convert2crhmc_input<Input, Polytope, Func, Grad, Hess>(P, f, g, h))
+        ,   problem(input)
+    {
+        problem.options.simdLen = simdLen;
+        if (problem.terminate) return;
+        shift = problem.T * problem.center + problem.y;
+        problem.y -= shift;
+    }
+
+    crhmc_gaussian_problem(crhmc_gaussian_problem const&) = delete;
+
+    void set_variance(NT const& a)
+    {
+        params.a = a;
+        params.L = NT(2) * a;
+        params.m = NT(2) * a;
+    }
+
+    // the dimension of the affine hull of the polytope
+    unsigned int dimension() const
+    {
+        return problem.dimension() - problem.equations();
+    }
+};
+
+// the distances of the origin of the gaussians to the facets of an H-polytope
+template <typename Point, typename VT, typename NT>
+void get_dists_from_center(HPolytope<Point> &P, VT const& center, std::vector<NT> &dists)
+{
+    VT slack = P.get_vec() - P.get_mat() * center;
+    for (int i = 0; i < slack.size(); ++i) {
+        dists.push_back(slack(i) / P.get_mat().row(i).norm());
+    }
+}
+
+// the same for a constraint problem; the implicit equalities, e.g. fixed variables,
+// are facets at distance zero that the affine hull of the polytope lies on, so they
+// are skipped, as the equalities
+template <typename MT, typename Point, typename VT, typename NT>
+void get_dists_from_center(constraint_problem<MT, Point> &P, VT const& center,
+                           std::vector<NT> &dists)
+{
+    const NT tol = 1e-9;
+    MT A;
+    VT b, lb, ub;
+    std::tie(A, b) = P.get_inequalities();
+    std::tie(lb, ub) = P.get_bounds();
+
+    VT slack = b - A * center;
+    VT row_norms = (A.cwiseProduct(A) * VT::Ones(A.cols())).cwiseSqrt();
+    for (int i = 0; i < slack.size(); ++i) {
+        if (slack(i) > tol * row_norms(i)) dists.push_back(slack(i) / row_norms(i));
+    }
+    for (int j = 0; j < center.size(); ++j) {
+        if (ub(j) - lb(j) <= tol) continue;
+        dists.push_back(center(j) - lb(j));
+        dists.push_back(ub(j) - center(j));
+    }
+}
+
+// the fingerprint of a constraint problem, that has no single matrix
+template <typename MT, typename Point>
+std::uint64_t polytope_fingerprint(constraint_problem<MT, Point> &P)
+{
+    typedef typename constraint_problem<MT, Point>::VT VT;
+    fnv1a_hasher hasher;
+    MT A;
+    VT b, lb, ub;
+    std::tie(A, b) = P.get_equations();
+    hasher.add(A);
+    hasher.add(b);
+    std::tie(A, b) = P.get_inequalities();
+    hasher.add(A);
+    hasher.add(b);
+    std::tie(lb, ub) = P.get_bounds();
+    hasher.add(lb);
+    hasher.add(ub);
+    return hasher.value();
+}
+
 // Compute the sequence of spherical gaussians
 template
 <
     int simdLen,
     typename Polytope,
+    typename GaussianProblem,
     typename NT,
     typename RandomNumberGenerator
 >
 void compute_annealing_schedule(Polytope& P,
+                                GaussianProblem& gaussian_problem,
+                                std::vector<NT> const& dists,
                                 NT const& ratio,
                                 NT const& C,
                                 NT const& frac,
                                 unsigned int const& N,
                                 unsigned int const& walk_length,
-                                NT const& chebychev_radius,
                                 NT const& error,
                                 std::vector<NT>& a_vals,
-                                RandomNumberGenerator& rng)
+                                RandomNumberGenerator& rng,
+                                VolumeCheckpointer<double>* checkpointer = NULL)
 {
     typedef typename Polytope::PointType Point;
-    typedef typename Polytope::MT 	MT;
-    
-    typedef typename GaussianFunctor::FunctionFunctor<Point>    Func;
-    typedef typename GaussianFunctor::GradientFunctor<Point>    Grad;
-    typedef typename GaussianFunctor::HessianFunctor<Point>     Hess;
-    typedef typename GaussianFunctor::parameters<NT, Point>     func_params;
-
-    typedef crhmc_input<MT, Point, Func, Grad, Hess> Input;
-    typedef crhmc_problem<Point, Input> CrhmcProblem;   
+    typedef typename GaussianProblem::Func Func;
+    typedef typename GaussianProblem::Grad Grad;
+    typedef typename GaussianProblem::CrhmcProblem CrhmcProblem;
 
     typedef ImplicitMidpointODESolver<Point, NT, CrhmcProblem, Grad, simdLen> Solver;
 
@@ -144,16 +271,20 @@ void compute_annealing_schedule(Polytope& P,
                   Grad
           > crhmc_walk_params;
 
-    typedef CrhmcRandomPointGenerator<CRHMCWalkType> CRHMCRandomPointGenerator;
 
-
-    // Compute the first gaussian
+    // Compute the first gaussian, or continue the schedule of a resumed run
     // This uses the function from the standard volume_cooling_gaussians.hpp
-    get_first_gaussian(P, frac, chebychev_radius, error, a_vals);
+    if (checkpointer != NULL && !checkpointer->state().schedule.empty())
+    {
+        a_vals.assign(checkpointer->state().schedule.begin(),
+                      checkpointer->state().schedule.end());
+        checkpointer->restore_rng(rng);
+    } else {
+        get_first_gaussian(dists, frac, error, a_vals);
+    }
     NT a_stop = 0.0;
     const NT tol = 0.001;
-    unsigned int it = 0;
-    unsigned int n = P.dimension();
+    unsigned int it = a_vals.size() - 1;
     const unsigned int totalSteps = ((int)150/((1.0 - frac) * error))+1;
 
     if (a_vals[0]<a_stop) a_vals[0] = a_stop;
@@ -166,6 +297,8 @@ void compute_annealing_schedule(Polytope& P,
     std::cout<<"Computing the sequence of gaussians..\n"<<std::endl;
 #endif
 
+    CrhmcProblem &problem = gaussian_problem.problem;
+
     while (true)
     {
 
@@ -173,41 +306,25 @@ void compute_annealing_schedule(Polytope& P,
         NT curr_its = 0;
         auto steps = totalSteps;
 
-        //TODO: potential problem creation and preprocessing optimization
-        
-        //create the crhmc problem for this variance
-        int dimension = P.dimension();
-        func_params f_params = func_params(Point(dimension), a_vals[it], 1);
-        
-        Func f(f_params);
-        Grad g(f_params);
-        Hess h(f_params);
-
-        Input input = convert2crhmc_input<Input, Polytope, Func, Grad, Hess>(P, f, g, h);
-
-        typedef crhmc_problem<Point, Input> CrhmcProblem;
-        CrhmcProblem problem = CrhmcProblem(input);
+        // the preprocessed problem is shared, only the variance changes
+        gaussian_problem.set_variance(a_vals[it]);
 
         Point p = Point(problem.center);
 
-        if(problem.terminate){return;}
+        crhmc_walk_params params(gaussian_problem.g, p.dimension(), problem.options);
 
-        problem.options.simdLen = simdLen;
-        crhmc_walk_params params(input.df, p.dimension(), problem.options);
-
-        if (input.df.params.eta > 0) {
-            params.eta = input.df.params.eta;
+        if (gaussian_problem.params.eta > 0) {
+            params.eta = gaussian_problem.params.eta;
         }
 
-        int dim;
-        dim = p.dimension();
-
         //create the walk object for this problem
-        CRHMCWalkType walk = CRHMCWalkType(problem, p, input.df, input.f, params);
+        CRHMCWalkType walk = CRHMCWalkType(problem, p, gaussian_problem.g, gaussian_problem.f, params);
+        warm_up_walk(walk, rng, walk_length);
 
         // Compute the next gaussian
         NT next_a = get_next_gaussian<CRHMCWalkType, crhmc_walk_params, simdLen, Grad, Func, CrhmcProblem>
-                      (P, p, a_vals[it], N, ratio, C, walk_length, rng, g, f, params, problem, walk);
+                      (P, p, a_vals[it], N, ratio, C, walk_length, rng, gaussian_problem.g,
+                       gaussian_problem.f, params, problem, walk);
 
 #ifdef VOLESTI_DEBUG
     std::cout<<"Next Gaussian " << next_a <<std::endl;
@@ -236,6 +353,14 @@ void compute_annealing_schedule(Polytope& P,
         {
             a_vals.push_back(next_a);
             it++;
+
+            // every gaussian starts from the center of the problem,
+            // so the schedule and the generator is all that has to be saved
+            if (checkpointer != NULL && checkpointer->due())
+            {
+                checkpointer->state().schedule.assign(a_vals.begin(), a_vals.end());
+                checkpointer->save(rng);
+            }
         } else if (next_a <= 0)
         {
             a_vals.push_back(a_stop);
@@ -251,6 +376,9 @@ void compute_annealing_schedule(Polytope& P,
 #endif
 }
 
+// The volume of an H-polytope or of a constraint problem, i.e. a polytope given by
+// sparse inequalities, equalities and bounds. For equalities, or implicit equalities,
+// it is the volume in the affine hull of the polytope.
 template
 <
     typename Polytope,
@@ -260,19 +388,16 @@ template
 double volume_cooling_gaussians(Polytope& Pin,
                                 RandomNumberGenerator& rng,
                                 double const& error = 0.1,
-                                unsigned int const& walk_length = 1)
+                                unsigned int const& walk_length = 1,
+                                VolumeCheckpointer<double>* checkpointer = NULL)
 {
     typedef typename Polytope::PointType Point;
     typedef typename Point::FT 	NT;
     typedef typename Polytope::VT 	VT;
-    typedef typename Polytope::MT 	MT;
-    typedef typename GaussianFunctor::FunctionFunctor<Point>    Func;
-    typedef typename GaussianFunctor::GradientFunctor<Point>    Grad;
-    typedef typename GaussianFunctor::HessianFunctor<Point>     Hess;
-    typedef typename GaussianFunctor::parameters<NT, Point>     func_params;
-
-    typedef crhmc_input<MT, Point, Func, Grad, Hess> Input;
-    typedef crhmc_problem<Point, Input> CrhmcProblem;   
+    typedef crhmc_gaussian_problem<Polytope, Point> GaussianProblem;
+    typedef typename GaussianProblem::Func Func;
+    typedef typename GaussianProblem::Grad Grad;
+    typedef typename GaussianProblem::CrhmcProblem CrhmcProblem;
 
     typedef ImplicitMidpointODESolver<Point, NT, CrhmcProblem, Grad, simdLen> Solver;
 
@@ -291,23 +416,21 @@ double volume_cooling_gaussians(Polytope& Pin,
                   NT,
                   Grad
           > crhmc_walk_params;
-    
-    typedef CrhmcRandomPointGenerator<CRHMCWalkType> CRHMCRandomPointGenerator;
 
-    auto P(Pin); //copy and work with P because we are going to shift
-    unsigned int n = P.dimension();
-    unsigned int m = P.num_of_hyperplanes();
-    gaussian_annealing_parameters<NT> parameters(P.dimension());
+    Polytope &P = Pin;
 
-    // Consider Chebychev center as an internal point
-    auto InnerBall = P.ComputeInnerBall();
-    if (InnerBall.second < 0.0) return -1.0;
+    // Preprocess the polytope once for all the gaussians; its center is
+    // an internal point, that the gaussians are centered at
+    GaussianProblem gaussian_problem(P, simdLen);
+    CrhmcProblem &problem = gaussian_problem.problem;
+    if (problem.terminate) return -1.0;
 
-    Point c = InnerBall.first;
-    NT radius = InnerBall.second;
+    std::vector<NT> dists;
+    get_dists_from_center(P, VT(gaussian_problem.shift), dists);
+    if (dists.empty()) return -1.0;
 
-    // Move the chebychev center to the origin and apply the same shifting to the polytope
-    P.shift(c.getCoefficients());
+    unsigned int n = gaussian_problem.dimension();
+    gaussian_annealing_parameters<NT> parameters(n);
 
     // Computing the sequence of gaussians
 #ifdef VOLESTI_DEBUG
@@ -321,7 +444,20 @@ double volume_cooling_gaussians(Polytope& Pin,
     NT C = parameters.C;
     unsigned int N = parameters.N;
 
-    compute_annealing_schedule<simdLen>(P, ratio, C, parameters.frac, N, walk_length, radius, error, a_vals, rng);
+    const bool resumed = (checkpointer != NULL)
+                         && checkpointer->resume(checkpoint_cooling_gaussians_crhmc, n,
+                                                              polytope_fingerprint(P));
+
+    if (resumed && checkpointer->state().schedule_done)
+    {
+        a_vals.assign(checkpointer->state().schedule.begin(),
+                      checkpointer->state().schedule.end());
+        checkpointer->restore_rng(rng);
+    } else {
+        compute_annealing_schedule<simdLen>(P, gaussian_problem, dists, ratio, C,
+                                            parameters.frac, N, walk_length, error,
+                                            a_vals, rng, checkpointer);
+    }
 
 #ifdef VOLESTI_DEBUG
     std::cout<<"All the variances of schedule_annealing computed in = "
@@ -339,8 +475,6 @@ double volume_cooling_gaussians(Polytope& Pin,
     std::vector<NT> last_W2(W,0);
     std::vector<NT> fn(mm,0);
     std::vector<NT> its(mm,0);
-    VT lamdas;
-    lamdas.setZero(m);
     NT vol = std::pow(M_PI/a_vals[0], (NT(n))/2.0);
     unsigned int i=0;
 
@@ -349,6 +483,16 @@ double volume_cooling_gaussians(Polytope& Pin,
     viterator avalsIt = a_vals.begin();
     viterator minmaxIt;
 
+    // the schedule is always saved, the ratios are saved when the interval elapses
+    if (checkpointer != NULL && !checkpointer->state().schedule_done)
+    {
+        volume_checkpoint<double> &state = checkpointer->state();
+        state.schedule.assign(a_vals.begin(), a_vals.end());
+        state.schedule_done = 1;
+        state.phase_done.assign(mm, 0);
+        state.phase_values.assign(2 * mm, 0.0);
+        checkpointer->save(rng);
+    }
 
 #ifdef VOLESTI_DEBUG
     std::cout<<"volume of the first gaussian = "<<vol<<"\n"<<std::endl;
@@ -371,32 +515,28 @@ double volume_cooling_gaussians(Polytope& Pin,
         unsigned int min_steps = 0;
         std::vector<NT> last_W = last_W2;
 
-        // Set the radius for the ball walk
-        //creating the walk object
-        int dimension = P.dimension();
-        func_params f_params = func_params(Point(dimension), *avalsIt, 1);
-        
-        Func f(f_params);
-        Grad g(f_params);
-        Hess h(f_params);
-
-        //create the crhmc problem
-        Input input = convert2crhmc_input<Input, Polytope, Func, Grad, Hess>(P, f, g, h);
+        if (checkpointer != NULL && checkpointer->state().phase_done[i])
+        {
+            // the ratio has been estimated by the run that wrote the checkpoint
+            *fnIt = checkpointer->state().phase_values[2 * i];
+            *itsIt = checkpointer->state().phase_values[2 * i + 1];
+            vol *= ((*fnIt) / (*itsIt));
+            continue;
+        }
 
-        CrhmcProblem problem = CrhmcProblem(input);
+        // the walk of this phase samples from the gaussian with variance a_i
+        gaussian_problem.set_variance(*avalsIt);
 
         Point p = Point(problem.center);
 
-        if(problem.terminate){return 0;}
+        crhmc_walk_params params(gaussian_problem.g, p.dimension(), problem.options);
 
-        problem.options.simdLen=simdLen;
-        crhmc_walk_params params(input.df, p.dimension(), problem.options);
-
-        if (input.df.params.eta > 0) {
-            params.eta = input.df.params.eta;
+        if (gaussian_problem.params.eta > 0) {
+            params.eta = gaussian_problem.params.eta;
         }
 
-        CRHMCWalkType walk = CRHMCWalkType(problem, p, input.df, input.f, params);
+        CRHMCWalkType walk = CRHMCWalkType(problem, p, gaussian_problem.g, gaussian_problem.f, params);
+        warm_up_walk(walk, rng, walk_length);
 
         while (!done || (*itsIt)<min_steps)
         {
@@ -442,6 +582,15 @@ double volume_cooling_gaussians(Polytope& Pin,
                   << " N_" << i << " = " << *itsIt << std::endl;
 #endif
         vol *= ((*fnIt) / (*itsIt));
+
+        if (checkpointer != NULL)
+        {
+            volume_checkpoint<double> &state = checkpointer->state();
+            state.phase_done[i] = 1;
+            state.phase_values[2 * i] = *fnIt;
+            state.phase_values[2 * i + 1] = *itsIt;
+            if (checkpointer->due()) checkpointer->save(rng);
+        }
     }
 
 #ifdef VOLESTI_DEBUG
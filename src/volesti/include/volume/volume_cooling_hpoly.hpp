@@ -8,6 +8,7 @@
 #ifndef VOLUME_COOLING_HPOLY_HPP
 #define VOLUME_COOLING_HPOLY_HPP
 
+#include <limits>
 #include "volume/volume_cooling_gaussians.hpp"
 #include "sampling/random_point_generators.hpp"
 #include "preprocess/min_sampling_covering_ellipsoid_rounding.hpp"
@@ -209,6 +210,54 @@ bool get_sequence_of_zonopolys(Zonotope &Z,
     }
 }
 
+// estimate the i-th ratio of the sequence Z \cap HP_0, ..., Z \cap HP_{k-1}, Z \cap HP
+// of the schedule, i.e. i = 0: vol(Z \cap HP_0) / vol(Z), with HP_0 = HP if k = 0
+// (skipped if the schedule found HP to contain Z), and
+// i > 0: vol(Z \cap HP_i) / vol(Z \cap HP_{i-1}), with HP_k = HP;
+// every phase only reads the bodies and the ratios, thus phases are independent
+template
+<
+    typename WalkType,
+    typename Point,
+    typename ZonoHP,
+    typename Zonotope,
+    typename HPolytope,
+    typename NT,
+    typename RNG
+>
+NT estimate_ratio_of_zonopoly_phase(Zonotope &P,
+                                    HPolytope &HP,
+                                    std::vector<HPolytope> &HPolySet,
+                                    std::vector<NT> const& ratios,
+                                    int const& i,
+                                    NT const& er,
+                                    NT const& prob,
+                                    int const& N_times_nu,
+                                    unsigned int const& walk_length,
+                                    cooling_ball_parameters<NT> const& parameters,
+                                    RNG& rng)
+{
+    HPolytope &b2 = (std::size_t(i) < HPolySet.size()) ? HPolySet[i] : HP;
+
+    if (i == 0)
+    {
+        if (HPolySet.size() == 0 && ratios[0] == 1) return NT(1);
+
+        return (!parameters.window2) ?
+                estimate_ratio_interval<WalkType, Point>(P, b2, ratios[0], er, parameters.win_len,
+                                                         N_times_nu, prob, walk_length, rng)
+              : estimate_ratio<WalkType, Point>(P, b2, ratios[0], er, parameters.win_len,
+                                                N_times_nu, walk_length, rng);
+    }
+
+    ZonoHP zb1(P, HPolySet[i - 1]);
+    return (!parameters.window2) ?
+            estimate_ratio_interval<WalkType, Point>(zb1, b2, ratios[i], er, parameters.win_len,
+                                                     N_times_nu, prob, walk_length, rng)
+          : estimate_ratio<WalkType, Point>(zb1, b2, ratios[i], er, parameters.win_len,
+                                            N_times_nu, walk_length, rng);
+}
+
 // TODO: Rewrite to avoid some matrix operations and improve the signature
 template
         <
@@ -256,7 +305,8 @@ double volume_cooling_hpoly (Zonotope const& Pin,
                              RandomNumberGenerator &rng,
                              double const& error = 1.0,
                              unsigned int const& walk_length = 1,
-                             unsigned int const& win_len = 200)
+                             unsigned int const& win_len = 200,
+                             unsigned int const& num_threads = 1)
 {
 
     typedef typename Zonotope::PointType            Point;
@@ -307,59 +357,63 @@ double volume_cooling_hpoly (Zonotope const& Pin,
     HPolytope HP2(HP);
     std::pair<Point, NT> InnerBall = HP2.ComputeInnerBall();
     std::tuple<MT, VT, NT> res = min_sampling_covering_ellipsoid_rounding<CDHRWalk, MT, VT>(HP2, InnerBall,
-                                                                                            10 + 10 * n, rng);
-    NT vol = std::get<2>(res) * volume_cooling_gaussians<GaussianCDHRWalk>(HP2, rng, Her/2.0, 1);
-
-    if (!parameters.window2) {
-        vol *= estimate_ratio_interval<CdhrWalk, Point>(HP, P, ratio, er0, parameters.win_len, 1200,
-                                                        prob, 10 + 10 * n, rng);
-    } else {
-        vol *= estimate_ratio<CdhrWalk, Point>(HP, P, ratio, er0, parameters.win_len, 1200, 10 + 10 * n, rng);
-    }
-
-    HPolytope b1, b2;
-    if (HPolySet.size()==0) {
-        if (ratios[0]!=1) {
-            if(!parameters.window2) {
-                vol = vol / estimate_ratio_interval<WalkType, Point>(P, HP, ratios[0], er1, parameters.win_len, N_times_nu,
-                                                                     prob, walk_length, rng);
-            } else {
-                vol = vol / estimate_ratio<WalkType, Point>(P, HP, ratios[0], er1, parameters.win_len, N_times_nu,
-                                                            walk_length, rng);
-            }
+                                                                                            10 + 10 * n, rng,
+                                                                                            num_threads);
+    NT vol = std::get<2>(res) * volume_cooling_gaussians<GaussianCDHRWalk>(HP2, rng, Her/2.0, 1,
+                                                                           num_threads);
+
+    // the ratio vol(HP \cap Z) / vol(HP) and then the ratios of the phases of the schedule
+    int num_phases = (HPolySet.size() == 0) ? 1 : HPolySet.size() + 1;
+    if (HPolySet.size() > 0) er1 = er1 / std::sqrt(NT(mm)-1.0);
+
+    auto estimate_hpoly_ratio = [&](Zonotope &Z, HPolytope &H, RandomNumberGenerator &rng_i) {
+        return (!parameters.window2) ?
+                estimate_ratio_interval<CdhrWalk, Point>(H, Z, ratio, er0, parameters.win_len, 1200,
+                                                         prob, 10 + 10 * n, rng_i)
+              : estimate_ratio<CdhrWalk, Point>(H, Z, ratio, er0, parameters.win_len, 1200,
+                                                10 + 10 * n, rng_i);
+    };
+
+    if (num_threads <= 1)
+    {
+        vol *= estimate_hpoly_ratio(P, HP, rng);
+        for (int i = 0; i < num_phases; ++i)
+        {
+            vol = vol / estimate_ratio_of_zonopoly_phase<WalkType, Point, ZonoHP>
+                            (P, HP, HPolySet, ratios, i, er1, prob, N_times_nu,
+                             walk_length, parameters, rng);
         }
     } else {
-        er1 = er1 / std::sqrt(NT(mm)-1.0);
-        b1 = HPolySet[0];
-        if(!parameters.window2) {
-            vol = vol / estimate_ratio_interval<WalkType, Point>(P, b1, ratios[0], er1, parameters.win_len, N_times_nu,
-                                                                 prob, walk_length, rng);
-        } else {
-            vol = vol / estimate_ratio<WalkType, Point>(P, b1, ratios[0], er1, parameters.win_len, N_times_nu,
-                                                        walk_length, rng);
+        // estimate all the ratios concurrently; each one uses its own copies of the
+        // bodies, thus its own ray-shooting and membership LPs, and its own random
+        // stream seeded by rng, so the estimation does not depend on the number of threads
+        std::vector<unsigned int> seeds(num_phases + 1);
+        for (int i = 0; i <= num_phases; ++i)
+        {
+            seeds[i] = (unsigned int)(rng.sample_urdist()
+                                      * NT(std::numeric_limits<unsigned int>::max()));
         }
+        std::vector<NT> phase_ratios(num_phases + 1, NT(1));
 
-        for (int i = 0; i < HPolySet.size()-1; ++i) {
-            ZonoHP zb1(P,HPolySet[i]);
-            b2 = HPolySet[i+1];
-            if(!parameters.window2) {
-                vol = vol / estimate_ratio_interval<WalkType, Point>(zb1, b2, ratios[i], er1, parameters.win_len,
-                                                                     N_times_nu, prob, walk_length, rng);
-            } else {
-                vol = vol / estimate_ratio<WalkType, Point>(zb1, b2, ratios[i], er1, parameters.win_len, N_times_nu,
-                                                            walk_length, rng);
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+        for (int i = 0; i <= num_phases; ++i)
+        {
+            Zonotope P_i(P);
+            HPolytope HP_i(HP);
+            RandomNumberGenerator rng_i(n);
+            rng_i.set_seed(seeds[i]);
+            if (i == 0)
+            {
+                phase_ratios[i] = estimate_hpoly_ratio(P_i, HP_i, rng_i);
+                continue;
             }
+            std::vector<HPolytope> HPolySet_i(HPolySet);
+            phase_ratios[i] = NT(1) / estimate_ratio_of_zonopoly_phase<WalkType, Point, ZonoHP>
+                                        (P_i, HP_i, HPolySet_i, ratios, i - 1, er1, prob,
+                                         N_times_nu, walk_length, parameters, rng_i);
         }
 
-        ZonoHP zb1(P, HPolySet[HPolySet.size() - 1]);
-        if (!parameters.window2) {
-            vol = vol / estimate_ratio_interval<WalkType, Point>(zb1, HP, ratios[ratios.size() - 1], er1,
-                                                                 parameters.win_len, N_times_nu, prob, walk_length,
-                                                                 rng);
-        } else {
-            vol = vol / estimate_ratio<WalkType, Point>(zb1, HP, ratios[ratios.size() - 1], er1, parameters.win_len,
-                                                        N_times_nu, walk_length, rng);
-        }
+        for (int i = 0; i <= num_phases; ++i) vol *= phase_ratios[i];
     }
 
     return vol;
@@ -376,10 +430,12 @@ template
 >
 double volume_cooling_hpoly(Polytope& Pin,
                                  double const& error = 0.1,
-                                 unsigned int const& walk_length = 1)
+                                 unsigned int const& walk_length = 1,
+                                 unsigned int const& num_threads = 1)
 {
     RandomNumberGenerator rng(Pin.dimension());
-    return volume_cooling_hpoly<WalkTypePolicy, HPolytope>(Pin, rng, error, walk_length);
+    return volume_cooling_hpoly<WalkTypePolicy, HPolytope>(Pin, rng, error, walk_length, 200,
+                                                           num_threads);
 }
 
 #endif // VOLUME_COOLING_HPOLY_HPP
@@ -10,7 +10,9 @@
 #ifndef VOLUME_SEQUENCE_OF_BALLS_HPP
 #define VOLUME_SEQUENCE_OF_BALLS_HPP
 
+#include <algorithm>
 #include <iterator>
+#include <limits>
 #include <vector>
 #include <list>
 #include <math.h>
@@ -81,41 +83,62 @@ double volume_sequence_of_balls(Polytope& Pin,
     P.shift(c.getCoefficients());
     c = Point(n);
 
-    // Scale by number of threads and prevent edge case rnum=0 from producing overflow later
-    rnum = rnum >= 2*n_threads ? rnum/n_threads : 2u;
+    // Every thread runs its own chain and samples its share of the rnum points in
+    // each ball intersection; a chain has at least two points
+    if (rnum < 2u) rnum = 2u;
+    const unsigned int num_chains = std::max(1u, std::min(n_threads, rnum / 2u));
     NT vol = NT(0);
 
-    // Perform the procedure for a number of threads and then take the average
-    for (auto t=0u; t<n_threads; t++)
+    // a single chain uses rng, otherwise every chain has its own generator
+    // seeded by rng, so the result depends only on the seed and n_threads
+    std::vector<RandomNumberGenerator> rngs(num_chains > 1 ? num_chains : 0, rng);
+    for (unsigned int t = 0; t < rngs.size(); ++t)
     {
-        // Generate the first random point in P
-        // Perform random walk on random point in the Chebychev ball
+        rngs[t].set_seed((unsigned int)(rng.sample_urdist()
+                         * NT(std::numeric_limits<unsigned int>::max())));
+    }
+    auto chain_rng = [&](unsigned int const& t) -> RandomNumberGenerator& {
+        return (num_chains > 1) ? rngs[t] : rng;
+    };
+    std::vector<unsigned int> chain_rnum(num_chains);
+    for (unsigned int t = 0; t < num_chains; ++t)
+    {
+        chain_rnum[t] = rnum / num_chains + (t < rnum % num_chains ? 1 : 0);
+    }
+    std::vector<std::list<Point>> chain_points(num_chains); //ds for storing rand points
+
+    // Generate the first random points in P
+    // Perform random walk on random point in the Chebychev ball
 #ifdef VOLESTI_DEBUG
-        std::cout<<"\nGenerate the first random point in P"<<std::endl;
+    std::cout<<"\nGenerate the first random point in P"<<std::endl;
+    double tstart2 = (double)clock()/(double)CLOCKS_PER_SEC;
+    std::cout<<"\nCompute "<<rnum<<" random points in P"<<std::endl;
 #endif
-        Point p = GetPointInDsphere<Point>::apply(P.dimension(), radius, rng);
-        std::list<Point> randPoints; //ds for storing rand points
+    #pragma omp parallel for num_threads(num_chains) if(num_chains > 1)
+    for (int t = 0; t < int(num_chains); ++t)
+    {
+        Polytope Pt(P);
+        Point p = GetPointInDsphere<Point>::apply(n, radius, chain_rng(t));
 
         PushBackWalkPolicy push_back_policy;
-        RandomPointGenerator::apply(P, p, 1, 50*n, randPoints, push_back_policy, rng);
-
-#ifdef VOLESTI_DEBUG
-        double tstart2 = (double)clock()/(double)CLOCKS_PER_SEC;
-        std::cout<<"\nCompute "<<rnum<<" random points in P"<<std::endl;
-#endif
-        RandomPointGenerator::apply(P, p, rnum-1, walk_length, randPoints,
-                                    push_back_policy, rng);
+        RandomPointGenerator::apply(Pt, p, 1, 50*n, chain_points[t], push_back_policy,
+                                    chain_rng(t));
+        RandomPointGenerator::apply(Pt, p, chain_rnum[t]-1, walk_length, chain_points[t],
+                                    push_back_policy, chain_rng(t));
+    }
 
 #ifdef VOLESTI_DEBUG
-        double tstop2 = (double)clock()/(double)CLOCKS_PER_SEC;
-        std::cout << "First random points construction time = "
-                  << tstop2 - tstart2 << std::endl;
+    double tstop2 = (double)clock()/(double)CLOCKS_PER_SEC;
+    std::cout << "First random points construction time = "
+              << tstop2 - tstart2 << std::endl;
 #endif
 
-        // Construct the sequence of balls
-        // a. compute the radius of the largest ball
-        NT current_dist, max_dist=NT(0);
-        for (auto pit=randPoints.begin(); pit!=randPoints.end(); ++pit)
+    // Construct the sequence of balls
+    // a. compute the radius of the largest ball
+    NT current_dist, max_dist=NT(0);
+    for (auto cit=chain_points.begin(); cit!=chain_points.end(); ++cit)
+    {
+        for (auto pit=cit->begin(); pit!=cit->end(); ++pit)
         {
             current_dist = (*pit).squared_length();
             if (current_dist > max_dist)
@@ -123,58 +146,68 @@ double volume_sequence_of_balls(Polytope& Pin,
                 max_dist=current_dist;
             }
         }
-        max_dist = std::sqrt(max_dist);
+    }
+    max_dist = std::sqrt(max_dist);
 #ifdef VOLESTI_DEBUG
-        std::cout<<"\nFurthest distance from Chebychev point= "<<max_dist
-                <<std::endl;
-        std::cout<<"\nConstructing the sequence of balls"<<std::endl;
-        std::cout<<"---------"<<std::endl;
+    std::cout<<"\nFurthest distance from Chebychev point= "<<max_dist
+            <<std::endl;
+    std::cout<<"\nConstructing the sequence of balls"<<std::endl;
+    std::cout<<"---------"<<std::endl;
 #endif
 
-        //
-        // b. Number of balls
-        int nb1 = n * (std::log(radius)/std::log(2.0));
-        int nb2 = std::ceil(n * (std::log(max_dist)/std::log(2.0)));
+    //
+    // b. Number of balls
+    int nb1 = n * (std::log(radius)/std::log(2.0));
+    int nb2 = std::ceil(n * (std::log(max_dist)/std::log(2.0)));
 
-        std::vector<Ball> balls;
+    std::vector<Ball> balls;
 
-        for (auto i=nb1; i<=nb2; ++i)
+    for (auto i=nb1; i<=nb2; ++i)
+    {
+        if (i == nb1)
         {
-            if (i == nb1)
-            {
-                balls.push_back(Ball(c,radius*radius));
-                vol = (std::pow(M_PI,n/2.0)*(std::pow(balls[0].radius(), n) ) )
-                       / (tgamma(n/2.0+1));
-            } else {
-                balls.push_back(Ball(c,std::pow(std::pow(2.0,NT(i)/NT(n)),2)));
-            }
+            balls.push_back(Ball(c,radius*radius));
+            vol = (std::pow(M_PI,n/2.0)*(std::pow(balls[0].radius(), n) ) )
+                   / (tgamma(n/2.0+1));
+        } else {
+            balls.push_back(Ball(c,std::pow(std::pow(2.0,NT(i)/NT(n)),2)));
         }
-        assert(!balls.empty());
+    }
+    assert(!balls.empty());
 
-        // Estimate Vol(P)
-        typename std::vector<Ball>::iterator bit2=balls.end();
-        bit2--;
+    // Estimate Vol(P)
+    typename std::vector<Ball>::iterator bit2=balls.end();
+    bit2--;
 
-        while (bit2!=balls.begin())
-        {
-            //each step starts with some random points in PBLarge stored
-            //in list "randPoints", these points have been generated in a
-            //previous step
+    std::vector<unsigned int> chain_PBSmall(num_chains);
 
-            BallPoly PBLarge(P,*bit2);
-            --bit2;
-            BallPoly PBSmall(P,*bit2);
+    while (bit2!=balls.begin())
+    {
+        //each step starts with some random points in PBLarge stored
+        //in the lists of the chains, these points have been generated in a
+        //previous step
+
+        Ball &BLarge = *bit2;
+        --bit2;
+        Ball &BSmall = *bit2;
 
 #ifdef VOLESTI_DEBUG
-            std::cout<<"("<<balls.end()-bit2<<"/"<<balls.end()-balls.begin()
-                     <<")Ball ratio radius="
-                     <<PBLarge.second().radius()<<","
-                     <<PBSmall.second().radius()<<std::endl;
-            std::cout<<"Points in PBLarge="<<randPoints.size()<<std::endl;
+        std::cout<<"("<<balls.end()-bit2<<"/"<<balls.end()-balls.begin()
+                 <<")Ball ratio radius="
+                 <<BLarge.radius()<<","
+                 <<BSmall.radius()<<std::endl;
 #endif
 
-            // choose a point in PBLarge to be used to generate more rand points
-            Point p_gen = *randPoints.begin();
+        #pragma omp parallel for num_threads(num_chains) if(num_chains > 1)
+        for (int t = 0; t < int(num_chains); ++t)
+        {
+            BallPoly PBLarge(P,BLarge);
+            BallPoly PBSmall(P,BSmall);
+            std::list<Point> &randPoints = chain_points[t];
+
+            // choose a point in PBLarge to be used to generate more rand points,
+            // the center of the balls if the chain has no point left
+            Point p_gen = randPoints.empty() ? c : *randPoints.begin();
 
             // num of points in PBSmall and PBLarge
             unsigned int nump_PBSmall = 0;
@@ -193,29 +226,26 @@ double volume_sequence_of_balls(Polytope& Pin,
                 }
             }
 
-#ifdef VOLESTI_DEBUG
-            std::cout<<"Points in PBSmall="<<randPoints.size()
-                     <<"\nRatio= "<<NT(nump_PBLarge)/NT(nump_PBSmall)
-                     <<std::endl;
-            std::cout<<"Generate "<<rnum-nump_PBLarge<<" more "<<std::endl;
-#endif
-
             CountingWalkPolicy<BallPoly> counting_policy(nump_PBSmall, PBSmall);
-            RandomPointGenerator::apply(PBLarge, p_gen, rnum-nump_PBLarge,
+            RandomPointGenerator::apply(PBLarge, p_gen, chain_rnum[t]-nump_PBLarge,
                                         walk_length, randPoints,
-                                        counting_policy, rng);
+                                        counting_policy, chain_rng(t));
 
-            nump_PBSmall = counting_policy.get_nump_PBSmall();
+            chain_PBSmall[t] = counting_policy.get_nump_PBSmall();
+        }
+
+        // the counts are integers, so the ratio does not depend on the threads
+        unsigned int nump_PBSmall = 0;
+        for (unsigned int t = 0; t < num_chains; ++t) nump_PBSmall += chain_PBSmall[t];
 
-            vol *= NT(rnum)/NT(nump_PBSmall);
+        vol *= NT(rnum)/NT(nump_PBSmall);
 
 #ifdef VOLESTI_DEBUG
-            std::cout<<nump_PBSmall<<"/"<<rnum<<" = "<<NT(rnum)/nump_PBSmall
-                     <<"\ncurrent_vol = "<<vol
-                     <<"\n--------------------------"<<std::endl;
+        std::cout<<nump_PBSmall<<"/"<<rnum<<" = "<<NT(rnum)/nump_PBSmall
+                 <<"\ncurrent_vol = "<<vol
+                 <<"\n--------------------------"<<std::endl;
 #endif
-            //don't continue in pairs of balls that are almost inside P, i.e. ratio ~= 2
-        }
+        //don't continue in pairs of balls that are almost inside P, i.e. ratio ~= 2
     }
 #ifdef VOLESTI_DEBUG
     std::cout<<"rand points = "<<rnum<<std::endl;
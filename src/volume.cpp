@@ -8,6 +8,10 @@
 //Contributed and/or modified by Apostolos Chalkis, as part of Google Summer of Code 2018 and 2019 program.
 
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
 #include <Rcpp.h>
 #include <RcppEigen.h>
 #include <boost/random.hpp>
@@ -20,17 +24,61 @@
 #include "volume/volume_cooling_gaussians.hpp"
 #include "volume/volume_cooling_balls.hpp"
 #include "volume/volume_cooling_hpoly.hpp"
+#include "volume/volume_cooling_gaussians_crhmc.hpp"
+#include "volume/volume_checkpoint.hpp"
+#include "volume/annealing_schedule_cache.hpp"
+#include "volume/anytime_volume.hpp"
 #include "preprocess/inscribed_ellipsoid_rounding.hpp"
 #include "preprocess/svd_rounding.hpp"
+#include "preprocess/crhmc/constraint_problem.h"
+#include "cachedInnerBall.h"
 
 enum random_walks {ball_walk, rdhr, cdhr, billiard, accelarated_billiard};
-enum volume_algorithms {CB, CG, SOB};
+enum volume_algorithms {CB, CG, SOB, CRHMC};
 enum rounding_type {none, min_ellipsoid, max_ellipsoid, isotropy};
 
+// the name of a walk in the settings, the billiard walk of H-polytopes is the accelerated one
+std::string walk_name(random_walks const& walk)
+{
+    switch (walk)
+    {
+    case ball_walk:
+        return std::string("BaW");
+    case rdhr:
+        return std::string("RDHR");
+    case cdhr:
+        return std::string("CDHR");
+    case billiard:
+        return std::string("BiW");
+    case accelarated_billiard:
+        return std::string("AcceleratedBiW");
+    }
+    return std::string();
+}
+
+// CRHMC is implemented only for H-polytopes and sparse constraint problems
+template <typename Polytope, typename RNGType, typename NT>
+NT crhmc_volume(Polytope&, RNGType&, NT, unsigned int, VolumeCheckpointer<NT>*)
+{
+    throw std::runtime_error("CRHMC algorithm can be used only for H-polytopes!");
+}
+
+template <typename Point, typename RNGType, typename NT>
+NT crhmc_volume(HPolytope<Point>& P, RNGType &rng, NT e, unsigned int walk_length,
+                VolumeCheckpointer<NT>* checkpointer)
+{
+    return volume_cooling_gaussians<HPolytope<Point>, RNGType, 4>(P, rng, e, walk_length, checkpointer);
+}
+
 template <typename Polytope,  typename RNGType,  typename NT>
 std::pair<double, double> generic_volume(Polytope& P, RNGType &rng, unsigned int walk_length, NT e,
                                          volume_algorithms const& algo, unsigned int win_len,
-                                         rounding_type const& rounding, random_walks const& walk)
+                                         rounding_type const& rounding, random_walks const& walk,
+                                         unsigned int num_threads = 1,
+                                         VolumeCheckpointer<NT>* checkpointer = NULL,
+                                         AnnealingScheduleCache<NT>* schedule_cache = NULL,
+                                         AnytimeVolume<NT>* progress = NULL,
+                                         NT const& seed = std::numeric_limits<NT>::quiet_NaN())
 {
     typedef typename Polytope::MT MT;
     typedef typename Polytope::VT VT;
@@ -41,10 +89,37 @@ std::pair<double, double> generic_volume(Polytope& P, RNGType &rng, unsigned int
     NT round_val = 1.0;
     unsigned int n = P.dimension();
     std::pair<Point, NT> InnerBall;
+    unsigned int continue_seed = 0;
+    bool reseed = false;
 
     if (rounding != none){
          InnerBall = P.ComputeInnerBall();
-         if (InnerBall.second < 0.0) throw Rcpp::exception("Unable to compute a feasible point.");
+         if (InnerBall.second < 0.0) throw std::runtime_error("Unable to compute a feasible point.");
+
+         // a resumed run repeats the rounding with the same seed to get the same polytope
+         if (checkpointer != NULL) {
+             if (!checkpointer->loaded()) {
+                 checkpointer->state().rounding_seed = (unsigned int)(rng.sample_urdist()
+                                                       * NT(std::numeric_limits<unsigned int>::max()));
+             }
+             rng.set_seed(checkpointer->state().rounding_seed);
+         }
+         // the schedules are cached for the rounded polytope, thus a random rounding is
+         // repeated with the seed of the first call with the same body, settings and seed
+         else if (schedule_cache != NULL) {
+             std::uint64_t key = AnnealingScheduleCache<NT>::key(P, std::string("rounding"), int(rounding),
+                                                                 walk_name(walk), num_threads, seed);
+             // both seeds are drawn in every call, so a seeded call continues the same
+             // way whether the rounding seed is cached or not
+             std::vector<NT> rounding_seed(1, std::floor(rng.sample_urdist()
+                                                         * NT(std::numeric_limits<unsigned int>::max()))), unused;
+             continue_seed = (unsigned int)(rng.sample_urdist() * NT(std::numeric_limits<unsigned int>::max()));
+             if (!schedule_cache->find(key, rounding_seed, unused)) {
+                 schedule_cache->insert(key, rounding_seed);
+             }
+             rng.set_seed((unsigned int)(rounding_seed[0]));
+             reseed = true;
+         }
     }
 
     switch (rounding)
@@ -53,13 +128,13 @@ std::pair<double, double> generic_volume(Polytope& P, RNGType &rng, unsigned int
         switch (walk)
         {
         case cdhr:
-            round_val = std::get<2>(min_sampling_covering_ellipsoid_rounding<CDHRWalk, MT, VT>(P, InnerBall, 10 + 10 * n, rng));
+            round_val = std::get<2>(min_sampling_covering_ellipsoid_rounding<CDHRWalk, MT, VT>(P, InnerBall, 10 + 10 * n, rng, num_threads));
             break;
         case accelarated_billiard:
-            round_val = std::get<2>(min_sampling_covering_ellipsoid_rounding<AcceleratedBilliardWalk, MT, VT>(P, InnerBall, 2, rng));
+            round_val = std::get<2>(min_sampling_covering_ellipsoid_rounding<AcceleratedBilliardWalk, MT, VT>(P, InnerBall, 2, rng, num_threads));
             break;
         default:
-            round_val = std::get<2>(min_sampling_covering_ellipsoid_rounding<BilliardWalk, MT, VT>(P, InnerBall, 2, rng));
+            round_val = std::get<2>(min_sampling_covering_ellipsoid_rounding<BilliardWalk, MT, VT>(P, InnerBall, 2, rng, num_threads));
             break;
         }
         break;
@@ -67,13 +142,13 @@ std::pair<double, double> generic_volume(Polytope& P, RNGType &rng, unsigned int
         switch (walk)
         {
         case cdhr:
-            round_val = std::get<2>(svd_rounding<CDHRWalk, MT, VT>(P, InnerBall, 10 + 10 * n, rng));
+            round_val = std::get<2>(svd_rounding<CDHRWalk, MT, VT>(P, InnerBall, 10 + 10 * n, rng, num_threads));
             break;
         case accelarated_billiard:
-            round_val = std::get<2>(svd_rounding<AcceleratedBilliardWalk, MT, VT>(P, InnerBall, 2, rng));
+            round_val = std::get<2>(svd_rounding<AcceleratedBilliardWalk, MT, VT>(P, InnerBall, 2, rng, num_threads));
             break;
         default:
-            round_val = std::get<2>(svd_rounding<BilliardWalk, MT, VT>(P, InnerBall, 2, rng));
+            round_val = std::get<2>(svd_rounding<BilliardWalk, MT, VT>(P, InnerBall, 2, rng, num_threads));
             break;
         }
         break;
@@ -84,6 +159,15 @@ std::pair<double, double> generic_volume(Polytope& P, RNGType &rng, unsigned int
         break;
     }
 
+    // the random walks of the volume algorithm do not repeat those of the first call
+    if (reseed) rng.set_seed(continue_seed);
+
+    // the anytime estimates are reported for the input polytope
+    if (progress != NULL) progress->add_log_factor(std::log(round_val));
+
+    // the cached schedules are stored under the name of the walk in the settings
+    const std::string name = walk_name(walk);
+
     NT vol;
     std::pair<double, double> pair_vol;
     switch (algo)
@@ -92,19 +176,22 @@ std::pair<double, double> generic_volume(Polytope& P, RNGType &rng, unsigned int
         switch (walk)
         {
         case cdhr:
-            vol = volume_cooling_gaussians<GaussianCDHRWalk>(P, rng, e, walk_length);
+            vol = volume_cooling_gaussians<GaussianCDHRWalk>(P, rng, e, walk_length, num_threads, checkpointer, schedule_cache,
+                                                             name);
             pair_vol = std::pair<double, double> (std::log(vol), vol);
             break;
         case rdhr:
-            vol = volume_cooling_gaussians<GaussianRDHRWalk>(P, rng, e, walk_length);
+            vol = volume_cooling_gaussians<GaussianRDHRWalk>(P, rng, e, walk_length, num_threads, checkpointer, schedule_cache,
+                                                             name);
             pair_vol = std::pair<double, double> (std::log(vol), vol);
             break;
         case ball_walk:
-            vol = volume_cooling_gaussians<GaussianBallWalk>(P, rng, e, walk_length);
+            vol = volume_cooling_gaussians<GaussianBallWalk>(P, rng, e, walk_length, num_threads, checkpointer, schedule_cache,
+                                                             name);
             pair_vol = std::pair<double, double> (std::log(vol), vol);
             break;
         default:
-            throw Rcpp::exception("This random walk can not be used by CG algorithm!");
+            throw std::runtime_error("This random walk can not be used by CG algorithm!");
             break;
         }
         break;
@@ -112,22 +199,27 @@ std::pair<double, double> generic_volume(Polytope& P, RNGType &rng, unsigned int
         switch (walk)
         {
         case cdhr:
-            pair_vol = volume_cooling_balls<CDHRWalk>(P, rng, e, walk_length, win_len);
+            pair_vol = volume_cooling_balls<CDHRWalk>(P, rng, e, walk_length, win_len, num_threads, checkpointer, schedule_cache,
+                                                          progress, name);
             break;
         case rdhr:
-            pair_vol = volume_cooling_balls<RDHRWalk>(P, rng, e, walk_length, win_len);
+            pair_vol = volume_cooling_balls<RDHRWalk>(P, rng, e, walk_length, win_len, num_threads, checkpointer, schedule_cache,
+                                                          progress, name);
             break;
         case ball_walk:
-            pair_vol = volume_cooling_balls<BallWalk>(P, rng, e, walk_length, win_len);
+            pair_vol = volume_cooling_balls<BallWalk>(P, rng, e, walk_length, win_len, num_threads, checkpointer, schedule_cache,
+                                                          progress, name);
             break;
         case billiard:
-            pair_vol = volume_cooling_balls<BilliardWalk>(P, rng, e, walk_length, win_len);
+            pair_vol = volume_cooling_balls<BilliardWalk>(P, rng, e, walk_length, win_len, num_threads, checkpointer, schedule_cache,
+                                                          progress, name);
             break;
         case accelarated_billiard:
-            pair_vol = volume_cooling_balls<AcceleratedBilliardWalk>(P, rng, e, walk_length, win_len);
+            pair_vol = volume_cooling_balls<AcceleratedBilliardWalk>(P, rng, e, walk_length, win_len, num_threads, checkpointer, schedule_cache,
+                                                          progress, name);
             break;
         default:
-            throw Rcpp::exception("This random walk can not be used by CB algorithm!");
+            throw std::runtime_error("This random walk can not be used by CB algorithm!");
             break;
         }
         break;
@@ -135,122 +227,65 @@ std::pair<double, double> generic_volume(Polytope& P, RNGType &rng, unsigned int
         switch (walk)
         {
         case cdhr:
-            vol = volume_sequence_of_balls<CDHRWalk>(P, rng, e, walk_length);
+            vol = volume_sequence_of_balls<CDHRWalk>(P, rng, e, walk_length, num_threads);
             pair_vol = std::pair<double, double> (std::log(vol), vol);
             break;
         case rdhr:
-            vol = volume_sequence_of_balls<RDHRWalk>(P, rng, e, walk_length);
+            vol = volume_sequence_of_balls<RDHRWalk>(P, rng, e, walk_length, num_threads);
             pair_vol = std::pair<double, double> (std::log(vol), vol);
             break;
         case ball_walk:
-            vol = volume_sequence_of_balls<BallWalk>(P, rng, e, walk_length);
+            vol = volume_sequence_of_balls<BallWalk>(P, rng, e, walk_length, num_threads);
             pair_vol = std::pair<double, double> (std::log(vol), vol);
             break;
         case billiard:
-            vol = volume_sequence_of_balls<BilliardWalk>(P, rng, e, walk_length);
+            vol = volume_sequence_of_balls<BilliardWalk>(P, rng, e, walk_length, num_threads);
+            pair_vol = std::pair<double, double> (std::log(vol), vol);
             break;
         case accelarated_billiard:
-            vol = volume_sequence_of_balls<AcceleratedBilliardWalk>(P, rng, e, walk_length);
+            vol = volume_sequence_of_balls<AcceleratedBilliardWalk>(P, rng, e, walk_length, num_threads);
             pair_vol = std::pair<double, double> (std::log(vol), vol);
             break;
         default:
-            throw Rcpp::exception("This random walk can not be used by CB algorithm!");
+            throw std::runtime_error("This random walk can not be used by SOB algorithm!");
             break;
         }
         break;
+    case CRHMC:
+        vol = crhmc_volume(P, rng, e, walk_length, checkpointer);
+        pair_vol = std::pair<double, double> (std::log(vol), vol);
+        break;
     default:
-        throw Rcpp::exception("Unknown algorithm!");
+        throw std::runtime_error("Unknown algorithm!");
         break;
     }
-    if (pair_vol.second < 0.0) throw Rcpp::exception("volesti failed to terminate.");
+    if (pair_vol.second < 0.0) throw std::runtime_error("volesti failed to terminate.");
     pair_vol.first += std::log(round_val);
     pair_vol.second *= round_val;
     return pair_vol;
 }
 
-//' The main function for volume approximation of a convex Polytope (H-polytope, V-polytope, zonotope or intersection of two V-polytopes). It returns a list with two elements: (a) the logarithm of the estimated volume and (b) the estimated volume
-//'
-//' For the volume approximation can be used three algorithms. Either CoolingBodies (CB) or SequenceOfBalls (SOB) or CoolingGaussian (CG). An H-polytope with \eqn{m} facets is described by a \eqn{m\times d} matrix \eqn{A} and a \eqn{m}-dimensional vector \eqn{b}, s.t.: \eqn{P=\{x\ |\  Ax\leq b\} }. A V-polytope is defined as the convex hull of \eqn{m} \eqn{d}-dimensional points which correspond to the vertices of P. A zonotope is desrcibed by the Minkowski sum of \eqn{m} \eqn{d}-dimensional segments.
-//'
-//' @param P A convex polytope. It is an object from class a) Hpolytope or b) Vpolytope or c) Zonotope or d) VpolytopeIntersection.
-//' @param settings Optional. A list that declares which algorithm, random walk and values of parameters to use, as follows:
-//' \describe{
-//' \item{\code{algorithm}}{A string to set the algorithm to use: a) \code{'CB'} for CB algorithm, b) \code{'SoB'} for SOB algorithm or b) \code{'CG'} for CG algorithm. The defalut algorithm is \code{'CB'}.}
-//' \item{\code{error}}{A numeric value to set the upper bound for the approximation error. The default value is \eqn{1} for SOB algorithm and \eqn{0.1} otherwise.}
-//' \item{\code{random_walk}}{A string that declares the random walk method: a) \code{'CDHR'} for Coordinate Directions Hit-and-Run, b) \code{'RDHR'} for Random Directions Hit-and-Run, c) \code{'BaW'} for Ball Walk, or \code{'BiW'} for Billiard walk. For CB algorithm the default walk is \code{'BiW'}. For CG and SOB algorithms the default walk is \code{'CDHR'} for H-polytopes and \code{'RDHR'} for the other representations.}
-//' \item{\code{walk_length}}{An integer to set the number of the steps for the random walk. The default value is \eqn{\lfloor 10 + d/10\rfloor} for \code{'SOB'} and \eqn{1} otherwise.}
-//' \item{\code{win_len}}{The length of the sliding window for CB or CG algorithm. The default value is \eqn{250} for CB with BiW and \eqn{400+3d^2} for CB and any other random walk and \eqn{500+4d^2} for CG.}
-//' \item{\code{hpoly}}{A boolean parameter to use H-polytopes in MMC of CB algorithm when the input polytope is a zonotope. The default value is \code{TRUE} when the order of the zonotope is \eqn{<5}, otherwise it is \code{FALSE}.}
-//' \item{\code{seed}}{A fixed seed for the number generator.}
-//' }
-//' @param rounding Optional. A string parameter to request a rounding method to be applied in the input polytope before volume computation: a) \code{'min_ellipsoid'}, b) \code{'svd'}, c) \code{'max_ellipsoid'} and d) \code{'none'} for no rounding.
-//'
-//' @references \cite{I.Z.Emiris and V. Fisikopoulos,
-//' \dQuote{Practical polytope volume approximation,} \emph{ACM Trans. Math. Soft.,} 2018.},
-//' @references \cite{A. Chalkis and I.Z.Emiris and V. Fisikopoulos,
-//' \dQuote{Practical Volume Estimation by a New Annealing Schedule for Cooling Convex Bodies,} \emph{CoRR, abs/1905.05494,} 2019.},
-//' @references \cite{B. Cousins and S. Vempala, \dQuote{A practical volume algorithm,} \emph{Springer-Verlag Berlin Heidelberg and The Mathematical Programming Society,} 2015.}
-//'
-//'
-//' @return The approximation of the volume of a convex polytope.
-//' @examples
-//'
-//' # calling SOB algorithm for a H-polytope (5d unit simplex)
-//' HP = gen_cube(5,'H')
-//' pair_vol = volume(HP)
-//'
-//' # calling CG algorithm for a V-polytope (3d simplex)
-//' VP = gen_simplex(3,'V')
-//' pair_vol = volume(VP, settings = list("algorithm" = "CG"))
-//'
-//' # calling CG algorithm for a 2-dimensional zonotope defined as the Minkowski sum of 4 segments
-//' Z = gen_rand_zonotope(2, 4)
-//' pair_vol = volume(Z, settings = list("random_walk" = "RDHR", "walk_length" = 2))
-//'
-//' @export
-// [[Rcpp::export]]
-Rcpp::List volume (Rcpp::Reference P,
-                   Rcpp::Nullable<Rcpp::List> settings = R_NilValue,
-                   Rcpp::Nullable<std::string> rounding = R_NilValue) {
+struct volume_settings
+{
+    volume_algorithms algo;
+    random_walks walk;
+    rounding_type rounding;
+    unsigned int walk_length;
+    unsigned int win_len;
+    unsigned int num_threads;
+    double error;
+};
 
+// parse the settings of volume() for a polytope of the given type and dimension,
+// type is 1 for H-polytopes, 2 for V-polytopes, 3 for zonotopes, 4 for intersections
+// and 5 for sparse H-polytopes
+volume_settings parse_volume_settings(Rcpp::Nullable<Rcpp::List> settings,
+                                      Rcpp::Nullable<std::string> rounding,
+                                      unsigned int n, unsigned int type)
+{
     typedef double NT;
-    typedef Cartesian<NT>    Kernel;
-    typedef typename Kernel::Point    Point;
-    typedef BoostRandomNumberGenerator<boost::mt19937, NT> RNGType;
-    typedef HPolytope <Point> Hpolytope;
-    typedef VPolytope <Point> Vpolytope;
-    typedef Zonotope <Point> zonotope;
-    typedef IntersectionOfVpoly<Vpolytope, RNGType> InterVP;
-    typedef Eigen::Matrix<NT,Eigen::Dynamic,1> VT;
-    typedef Eigen::Matrix<NT,Eigen::Dynamic,Eigen::Dynamic> MT;
 
-    unsigned int n, walkL, type;
-    std::string type_str = Rcpp::as<std::string>(P.slot("type"));
-
-    if (type_str.compare(std::string("Hpolytope")) == 0) {
-        n = Rcpp::as<MT>(P.slot("A")).cols();
-        type = 1;
-    } else if (type_str.compare(std::string("Vpolytope")) == 0) {
-        n = Rcpp::as<MT>(P.slot("V")).cols();
-        type = 2;
-    } else if (type_str.compare(std::string("Zonotope")) == 0) {
-        n = Rcpp::as<MT>(P.slot("G")).cols();
-        type = 3;
-    } else if (type_str.compare(std::string("VpolytopeIntersection")) == 0) {
-        n = Rcpp::as<MT>(P.slot("V1")).cols();
-        type = 4;
-    } else {
-        throw Rcpp::exception("Unknown polytope representation!");
-    }
-
-    RNGType rng(n);
-    if (Rcpp::as<Rcpp::List>(settings).containsElementNamed("seed")) {
-        unsigned seed_tmp = Rcpp::as<double>(Rcpp::as<Rcpp::List>(settings)["seed"]);
-        rng.set_seed(seed_tmp);
-    }
-
-    bool round = false, hpoly = false;
-    unsigned int win_len = 300;
+    unsigned int walkL, win_len = 300;
 
     random_walks walk;
     volume_algorithms algo;
@@ -295,11 +330,30 @@ Rcpp::List volume (Rcpp::Reference P,
                 Rcpp::as<Rcpp::List>(settings)["walk_length"]);
         e = (!Rcpp::as<Rcpp::List>(settings).containsElementNamed("error")) ? 0.1 : Rcpp::as<NT>(
                 Rcpp::as<Rcpp::List>(settings)["error"]);
+    } else if (Rcpp::as<std::string>(Rcpp::as<Rcpp::List>(settings)["algorithm"]).compare(std::string("CRHMC")) == 0) {
+        if (type != 1 && type != 5) throw Rcpp::exception("CRHMC algorithm can be used only for H-polytopes!");
+        algo = CRHMC;
+        walkL = (!Rcpp::as<Rcpp::List>(settings).containsElementNamed("walk_length")) ? 1 : Rcpp::as<int>(
+                Rcpp::as<Rcpp::List>(settings)["walk_length"]);
+        e = (!Rcpp::as<Rcpp::List>(settings).containsElementNamed("error")) ? 0.1 : Rcpp::as<NT>(
+                Rcpp::as<Rcpp::List>(settings)["error"]);
     } else {
         throw Rcpp::exception("Unknown method!");
     }
 
-    if (!Rcpp::as<Rcpp::List>(settings).containsElementNamed("random_walk")) {
+    if (type == 5 && algo != CRHMC) {
+        throw Rcpp::exception("Sparse polytopes are supported only by CRHMC algorithm.");
+    }
+
+    // CRHMC samples by its own walk and preprocesses the polytope itself
+    if (algo == CRHMC) {
+        if (Rcpp::as<Rcpp::List>(settings).containsElementNamed("random_walk"))
+            Rf_warning("input 'random_walk' can not be used by CRHMC algorithm.");
+        if (rounding.isNotNull() && Rcpp::as<std::string>(rounding).compare(std::string("none")) != 0)
+            Rf_warning("CRHMC algorithm rescales the polytope itself, the rounding is skipped.");
+        rounding_method = none;
+        walk = cdhr;
+    } else if (!Rcpp::as<Rcpp::List>(settings).containsElementNamed("random_walk")) {
         if (algo == CB) {
             walk = (type == 1) ? accelarated_billiard : billiard;
         } else {
@@ -341,7 +395,180 @@ Rcpp::List volume (Rcpp::Reference P,
 
     if (Rcpp::as<Rcpp::List>(settings).containsElementNamed("win_len")) {
         win_len = Rcpp::as<int>(Rcpp::as<Rcpp::List>(settings)["win_len"]);
-        if (algo == SOB) Rf_warning("input 'win_len' can be used only for CG or CB algorithms.");
+        if (algo == SOB || algo == CRHMC) Rf_warning("input 'win_len' can be used only for CG or CB algorithms.");
+    }
+
+    unsigned int num_threads = 1;
+    if (Rcpp::as<Rcpp::List>(settings).containsElementNamed("num_threads")) {
+        if (Rcpp::as<int>(Rcpp::as<Rcpp::List>(settings)["num_threads"]) < 1) {
+            throw Rcpp::exception("The number of threads has to be a positive integer!");
+        }
+        num_threads = Rcpp::as<int>(Rcpp::as<Rcpp::List>(settings)["num_threads"]);
+        if (algo == CRHMC) Rf_warning("input 'num_threads' can be used only for CG, CB or SOB algorithms.");
+    }
+
+    // generic_volume runs in the threads of volume_batch, so it can not throw an Rcpp::exception;
+    // the walks that it does not support are rejected here
+    if (algo == CG && walk != cdhr && walk != rdhr && walk != ball_walk) {
+        throw Rcpp::exception("This random walk can not be used by CG algorithm!");
+    }
+
+    volume_settings parsed;
+    parsed.algo = algo;
+    parsed.walk = walk;
+    parsed.rounding = rounding_method;
+    parsed.walk_length = walkL;
+    parsed.win_len = win_len;
+    parsed.num_threads = num_threads;
+    parsed.error = e;
+    return parsed;
+}
+
+//' The main function for volume approximation of a convex Polytope (H-polytope, V-polytope, zonotope or intersection of two V-polytopes). It returns a list with two elements: (a) the logarithm of the estimated volume and (b) the estimated volume
+//'
+//' For the volume approximation can be used three algorithms. Either CoolingBodies (CB) or SequenceOfBalls (SOB) or CoolingGaussian (CG). An H-polytope with \eqn{m} facets is described by a \eqn{m\times d} matrix \eqn{A} and a \eqn{m}-dimensional vector \eqn{b}, s.t.: \eqn{P=\{x\ |\  Ax\leq b\} }. A V-polytope is defined as the convex hull of \eqn{m} \eqn{d}-dimensional points which correspond to the vertices of P. A zonotope is desrcibed by the Minkowski sum of \eqn{m} \eqn{d}-dimensional segments.
+//'
+//' @param P A convex polytope. It is an object from class a) Hpolytope or b) Vpolytope or c) Zonotope or d) VpolytopeIntersection or e) HpolytopeSparse.
+//' @param settings Optional. A list that declares which algorithm, random walk and values of parameters to use, as follows:
+//' \describe{
+//' \item{\code{algorithm}}{A string to set the algorithm to use: a) \code{'CB'} for CB algorithm, b) \code{'SoB'} for SOB algorithm, c) \code{'CG'} for CG algorithm or d) \code{'CRHMC'} for CG algorithm with the Riemannian Hamiltonian Monte Carlo walk, which can be used only for H-polytopes and is the only algorithm for sparse H-polytopes. CRHMC preprocesses the polytope once and samples every gaussian of the annealing from it; for a polytope with equalities it computes the volume in the affine hull of the polytope. The defalut algorithm is \code{'CB'}.}
+//' \item{\code{error}}{A numeric value to set the upper bound for the approximation error. The default value is \eqn{1} for SOB algorithm and \eqn{0.1} otherwise.}
+//' \item{\code{random_walk}}{A string that declares the random walk method: a) \code{'CDHR'} for Coordinate Directions Hit-and-Run, b) \code{'RDHR'} for Random Directions Hit-and-Run, c) \code{'BaW'} for Ball Walk, or \code{'BiW'} for Billiard walk. For CB algorithm the default walk is \code{'BiW'}. For CG and SOB algorithms the default walk is \code{'CDHR'} for H-polytopes and \code{'RDHR'} for the other representations.}
+//' \item{\code{walk_length}}{An integer to set the number of the steps for the random walk. The default value is \eqn{\lfloor 10 + d/10\rfloor} for \code{'SOB'} and \eqn{1} otherwise.}
+//' \item{\code{win_len}}{The length of the sliding window for CB or CG algorithm. The default value is \eqn{250} for CB with BiW and \eqn{400+3d^2} for CB and any other random walk and \eqn{500+4d^2} for CG.}
+//' \item{\code{hpoly}}{A boolean parameter to use H-polytopes in MMC of CB algorithm when the input polytope is a zonotope. The default value is \code{TRUE} when the order of the zonotope is \eqn{<5}, otherwise it is \code{FALSE}. The inputs \code{checkpoint}, \code{schedule_cache}, \code{time_budget} and \code{trace} are not used with it.}
+//' \item{\code{seed}}{A fixed seed for the number generator.}
+//' \item{\code{num_threads}}{An integer to set the number of threads for CB, CG or SOB algorithm. When it is larger than \eqn{1}, CB estimates the ratios of all the phases of the schedule concurrently, also for zonotopes with \code{hpoly}, while CG and SOB run that many chains in parallel in every phase, each one with its own random number generator. The rounding methods \code{min_ellipsoid} and \code{isotropy} also split their samples over that many chains. The default value is \eqn{1}.}
+//' \item{\code{checkpoint}}{The path of a file to save the state of CB or CG algorithm periodically, i.e. the annealing schedule, the estimated ratios and the state of the random walks, so that an interrupted computation can be continued with \code{resume}. When \code{resume} is given the default is the resumed file.}
+//' \item{\code{checkpoint_interval}}{The minimum number of seconds between two saves of the checkpoint. The default value is \eqn{60}.}
+//' \item{\code{schedule_cache}}{A boolean parameter to keep the annealing schedules of CB and CG algorithms in memory for the rest of the session. A later call for the same polytope with the same rounding, seed, random walk, walk length and number of threads, and for CG with the same error, repeats the random rounding of the first call and skips the computation of the schedule. The default value is \code{FALSE}.}
+//' \item{\code{schedule_cache_dir}}{A directory to store the cached schedules, so that they are shared among sessions. It implies \code{schedule_cache = TRUE}.}
+//' \item{\code{time_budget}}{The number of seconds after which CB algorithm stops and returns its current estimate. The phases that are not completed use the rough ratios of the annealing schedule, which is always computed. The default value is \code{Inf}.}
+//' \item{\code{trace}}{A boolean parameter to return, for CB algorithm, the running estimate of the logarithm of the volume and its \eqn{95\%} confidence interval after every phase and every \eqn{1000} steps of a phase. The default value is \code{FALSE}.}
+//' }
+//' @param rounding Optional. A string parameter to request a rounding method to be applied in the input polytope before volume computation: a) \code{'min_ellipsoid'}, b) \code{'svd'}, c) \code{'max_ellipsoid'} and d) \code{'none'} for no rounding.
+//' @param resume Optional. The path of a checkpoint file that a previous call wrote for the same polytope, settings and rounding. The computation continues from the state stored in the file; a file written for another polytope is rejected.
+//'
+//' @references \cite{I.Z.Emiris and V. Fisikopoulos,
+//' \dQuote{Practical polytope volume approximation,} \emph{ACM Trans. Math. Soft.,} 2018.},
+//' @references \cite{A. Chalkis and I.Z.Emiris and V. Fisikopoulos,
+//' \dQuote{Practical Volume Estimation by a New Annealing Schedule for Cooling Convex Bodies,} \emph{CoRR, abs/1905.05494,} 2019.},
+//' @references \cite{B. Cousins and S. Vempala, \dQuote{A practical volume algorithm,} \emph{Springer-Verlag Berlin Heidelberg and The Mathematical Programming Society,} 2015.}
+//'
+//'
+//' @return The approximation of the volume of a convex polytope. If \code{trace} is requested, the list also contains \code{converged}, which is \code{FALSE} if the time budget stopped the computation, and \code{trace}, a data frame with the number of completed phases, the elapsed seconds, the number of steps of the random walks of the phases, the logarithm of the estimated volume and the bounds of its confidence interval at every report.
+//' @examples
+//'
+//' # calling SOB algorithm for a H-polytope (5d unit simplex)
+//' HP = gen_cube(5,'H')
+//' pair_vol = volume(HP)
+//'
+//' # calling CG algorithm for a V-polytope (3d simplex)
+//' VP = gen_simplex(3,'V')
+//' pair_vol = volume(VP, settings = list("algorithm" = "CG"))
+//'
+//' # calling CG algorithm for a 2-dimensional zonotope defined as the Minkowski sum of 4 segments
+//' Z = gen_rand_zonotope(2, 4)
+//' pair_vol = volume(Z, settings = list("random_walk" = "RDHR", "walk_length" = 2))
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List volume (Rcpp::Reference P,
+                   Rcpp::Nullable<Rcpp::List> settings = R_NilValue,
+                   Rcpp::Nullable<std::string> rounding = R_NilValue,
+                   Rcpp::Nullable<std::string> resume = R_NilValue) {
+
+    typedef double NT;
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT> RNGType;
+    typedef HPolytope <Point> Hpolytope;
+    typedef VPolytope <Point> Vpolytope;
+    typedef Zonotope <Point> zonotope;
+    typedef IntersectionOfVpoly<Vpolytope, RNGType> InterVP;
+    typedef Eigen::Matrix<NT,Eigen::Dynamic,1> VT;
+    typedef Eigen::Matrix<NT,Eigen::Dynamic,Eigen::Dynamic> MT;
+    typedef Eigen::SparseMatrix<NT> SpMat;
+    typedef constraint_problem<SpMat, Point> sparse_problem;
+
+    unsigned int n, type;
+    std::string type_str = Rcpp::as<std::string>(P.slot("type"));
+
+    if (type_str.compare(std::string("Hpolytope")) == 0) {
+        n = Rcpp::as<MT>(P.slot("A")).cols();
+        type = 1;
+    } else if (type_str.compare(std::string("Vpolytope")) == 0) {
+        n = Rcpp::as<MT>(P.slot("V")).cols();
+        type = 2;
+    } else if (type_str.compare(std::string("Zonotope")) == 0) {
+        n = Rcpp::as<MT>(P.slot("G")).cols();
+        type = 3;
+    } else if (type_str.compare(std::string("VpolytopeIntersection")) == 0) {
+        n = Rcpp::as<MT>(P.slot("V1")).cols();
+        type = 4;
+    } else if (type_str.compare(std::string("HpolytopeSparse")) == 0) {
+        n = Rcpp::as<SpMat>(P.slot("Aineq")).cols();
+        type = 5;
+    } else {
+        throw Rcpp::exception("Unknown polytope representation!");
+    }
+
+    RNGType rng(n);
+    NT seed = std::numeric_limits<NT>::quiet_NaN();
+    if (Rcpp::as<Rcpp::List>(settings).containsElementNamed("seed")) {
+        unsigned seed_tmp = Rcpp::as<double>(Rcpp::as<Rcpp::List>(settings)["seed"]);
+        rng.set_seed(seed_tmp);
+        seed = NT(seed_tmp);
+    }
+
+    bool hpoly = false;
+    volume_settings parsed = parse_volume_settings(settings, rounding, n, type);
+    volume_algorithms algo = parsed.algo;
+    random_walks walk = parsed.walk;
+    rounding_type rounding_method = parsed.rounding;
+    unsigned int walkL = parsed.walk_length, win_len = parsed.win_len, num_threads = parsed.num_threads;
+    NT e = parsed.error;
+
+    // the checkpoint is written in settings$checkpoint, or in the file that is resumed
+    std::unique_ptr<VolumeCheckpointer<NT>> checkpointer;
+    if (Rcpp::as<Rcpp::List>(settings).containsElementNamed("checkpoint") || resume.isNotNull()) {
+        if (algo == SOB) throw Rcpp::exception("Checkpoints can be used only for CG, CB or CRHMC algorithms!");
+        std::string filename = Rcpp::as<Rcpp::List>(settings).containsElementNamed("checkpoint") ?
+                Rcpp::as<std::string>(Rcpp::as<Rcpp::List>(settings)["checkpoint"]) : Rcpp::as<std::string>(resume);
+        NT interval = (!Rcpp::as<Rcpp::List>(settings).containsElementNamed("checkpoint_interval")) ? 60.0 :
+                Rcpp::as<NT>(Rcpp::as<Rcpp::List>(settings)["checkpoint_interval"]);
+        if (interval < 0.0) throw Rcpp::exception("The checkpoint interval has to be a non negative number!");
+        checkpointer.reset(new VolumeCheckpointer<NT>(filename, interval));
+        if (resume.isNotNull()) checkpointer->load(Rcpp::as<std::string>(resume));
+    }
+
+    // the schedules are kept for the whole session, and on disk if a directory is given
+    static AnnealingScheduleCache<NT> session_schedule_cache;
+    AnnealingScheduleCache<NT>* schedule_cache = NULL;
+    if (Rcpp::as<Rcpp::List>(settings).containsElementNamed("schedule_cache_dir")) {
+        session_schedule_cache.set_directory(Rcpp::as<std::string>(Rcpp::as<Rcpp::List>(settings)["schedule_cache_dir"]));
+        schedule_cache = &session_schedule_cache;
+    } else if (Rcpp::as<Rcpp::List>(settings).containsElementNamed("schedule_cache") &&
+               Rcpp::as<bool>(Rcpp::as<Rcpp::List>(settings)["schedule_cache"])) {
+        session_schedule_cache.set_directory(std::string());
+        schedule_cache = &session_schedule_cache;
+    }
+    if (schedule_cache != NULL && (algo == SOB || algo == CRHMC)) Rf_warning("input 'schedule_cache' can be used only for CG or CB algorithms.");
+
+    // an anytime CB computation stops at the time budget and may return its trace
+    std::unique_ptr<AnytimeVolume<NT>> progress;
+    bool trace = Rcpp::as<Rcpp::List>(settings).containsElementNamed("trace") &&
+                 Rcpp::as<bool>(Rcpp::as<Rcpp::List>(settings)["trace"]);
+    if (Rcpp::as<Rcpp::List>(settings).containsElementNamed("time_budget") || trace) {
+        if (algo != CB) {
+            Rf_warning("inputs 'time_budget' and 'trace' can be used only for CB algorithm.");
+            trace = false;
+        } else {
+            NT time_budget = (!Rcpp::as<Rcpp::List>(settings).containsElementNamed("time_budget")) ?
+                    std::numeric_limits<NT>::infinity() : Rcpp::as<NT>(Rcpp::as<Rcpp::List>(settings)["time_budget"]);
+            if (time_budget < 0.0) throw Rcpp::exception("The time budget has to be a non negative number!");
+            progress.reset(new AnytimeVolume<NT>(time_budget));
+        }
     }
 
     std::pair<NT, NT> pair_vol;
@@ -351,18 +578,22 @@ Rcpp::List volume (Rcpp::Reference P,
         case 1: {
             // Hpolytope
             Hpolytope HP(n, Rcpp::as<MT>(P.slot("A")), Rcpp::as<VT>(P.slot("b")));
-            pair_vol = generic_volume(HP, rng, walkL, e, algo, win_len, rounding_method, walk);
+            pair_vol = generic_volume(HP, rng, walkL, e, algo, win_len, rounding_method, walk, num_threads,
+                                      checkpointer.get(), schedule_cache, progress.get(), seed);
             break;
         }
         case 2: {
             // Vpolytope
             Vpolytope VP(n, Rcpp::as<MT>(P.slot("V")), VT::Ones(Rcpp::as<MT>(P.slot("V")).rows()));
-            pair_vol = generic_volume(VP, rng, walkL, e, algo, win_len, rounding_method, walk);
+            set_cached_inner_ball(P, VP);
+            pair_vol = generic_volume(VP, rng, walkL, e, algo, win_len, rounding_method, walk, num_threads,
+                                      checkpointer.get(), schedule_cache, progress.get(), seed);
             break;
         }
         case 3: {
             // Zonotope
             zonotope ZP(n, Rcpp::as<MT>(P.slot("G")), VT::Ones(Rcpp::as<MT>(P.slot("G")).rows()));
+            set_cached_inner_ball(P, ZP);
             if (Rcpp::as<Rcpp::List>(settings).containsElementNamed("hpoly")) {
                 hpoly = Rcpp::as<bool>(Rcpp::as<Rcpp::List>(settings)["hpoly"]);
                 if (hpoly && (algo == CG || algo == SOB))
@@ -373,53 +604,246 @@ Rcpp::List volume (Rcpp::Reference P,
                 hpoly = false;
             }
             if (hpoly && algo == CB) {
+                // the H-polytope approximation of the zonotope has no checkpoints, no cached
+                // schedules and no anytime estimates
+                if (checkpointer || schedule_cache != NULL || progress) {
+                    Rf_warning("inputs 'checkpoint', 'schedule_cache', 'time_budget' and 'trace' can not be used with 'hpoly'.");
+                    progress.reset();
+                    trace = false;
+                }
                 switch (walk)
                 {
                 case cdhr:
-                    vol = volume_cooling_hpoly<CDHRWalk, Hpolytope>(ZP, rng, e, walkL, win_len);
+                    vol = volume_cooling_hpoly<CDHRWalk, Hpolytope>(ZP, rng, e, walkL, win_len, num_threads);
                     pair_vol = std::pair<NT, NT> (std::log(vol), vol);
                     break;
                 case rdhr:
-                    vol = volume_cooling_hpoly<RDHRWalk, Hpolytope>(ZP, rng, e, walkL, win_len);
+                    vol = volume_cooling_hpoly<RDHRWalk, Hpolytope>(ZP, rng, e, walkL, win_len, num_threads);
                     pair_vol = std::pair<NT, NT> (std::log(vol), vol);
                     break;
                 case ball_walk:
-                    vol = volume_cooling_hpoly<BallWalk, Hpolytope>(ZP, rng, e, walkL, win_len);
+                    vol = volume_cooling_hpoly<BallWalk, Hpolytope>(ZP, rng, e, walkL, win_len, num_threads);
                     pair_vol = std::pair<NT, NT> (std::log(vol), vol);
                     break;
                 case billiard:
-                    vol = volume_cooling_hpoly<BilliardWalk, Hpolytope>(ZP, rng, e, walkL, win_len);
+                    vol = volume_cooling_hpoly<BilliardWalk, Hpolytope>(ZP, rng, e, walkL, win_len, num_threads);
                     pair_vol = std::pair<NT, NT> (std::log(vol), vol);
                     break;
                 case accelarated_billiard:
-                    vol = volume_cooling_hpoly<AcceleratedBilliardWalk, Hpolytope>(ZP, rng, e, walkL, win_len);
+                    vol = volume_cooling_hpoly<AcceleratedBilliardWalk, Hpolytope>(ZP, rng, e, walkL, win_len, num_threads);
                     pair_vol = std::pair<NT, NT> (std::log(vol), vol);
                     break;
                 default:
                     throw Rcpp::exception("This random walk can not be used by CB algorithm!");
                     break;
                 }
+            } else {
+                pair_vol = generic_volume(ZP, rng, walkL, e, algo, win_len, rounding_method, walk, num_threads,
+                                          checkpointer.get(), schedule_cache, progress.get(), seed);
             }
-            pair_vol = generic_volume(ZP, rng, walkL, e, algo, win_len, rounding_method, walk);
             break;
         }
         case 4: {
             // Intersection of two V-polytopes
             Vpolytope VP1(n, Rcpp::as<MT>(P.slot("V1")), VT::Ones(Rcpp::as<MT>(P.slot("V1")).rows()));
             Vpolytope VP2(n, Rcpp::as<MT>(P.slot("V2")), VT::Ones(Rcpp::as<MT>(P.slot("V2")).rows()));
-            InterVP VPcVP;
-            if (Rcpp::as<Rcpp::List>(settings).containsElementNamed("seed")) {
-                unsigned seed_tmp = Rcpp::as<double>(Rcpp::as<Rcpp::List>(settings)["seed"]);
-                rng.set_seed(seed_tmp);
-                InterVP VPcVP(VP1, VP2, seed_tmp);
-            } else {
-                InterVP VPcVP(VP1, VP2);
-            }
+            bool set_seed = Rcpp::as<Rcpp::List>(settings).containsElementNamed("seed");
+            unsigned seed_tmp = set_seed ? Rcpp::as<double>(Rcpp::as<Rcpp::List>(settings)["seed"]) : 0;
+            if (set_seed) rng.set_seed(seed_tmp);
+            InterVP VPcVP = set_seed ? InterVP(VP1, VP2, seed_tmp) : InterVP(VP1, VP2);
             if (!VPcVP.is_feasible()) throw Rcpp::exception("Empty set!");
-            pair_vol = generic_volume(VPcVP, rng, walkL, e, algo, win_len, rounding_method, walk);
+            pair_vol = generic_volume(VPcVP, rng, walkL, e, algo, win_len, rounding_method, walk, num_threads,
+                                      checkpointer.get(), schedule_cache, progress.get(), seed);
+            break;
+        }
+        case 5: {
+            // Sparse H-polytope with equalities and bounds; the volume is computed
+            // in the affine hull of the polytope
+            sparse_problem problem(n, Rcpp::as<SpMat>(P.slot("Aeq")), Rcpp::as<VT>(P.slot("beq")),
+                                   Rcpp::as<SpMat>(P.slot("Aineq")), Rcpp::as<VT>(P.slot("bineq")),
+                                   Rcpp::as<VT>(P.slot("lb")), Rcpp::as<VT>(P.slot("ub")));
+            vol = volume_cooling_gaussians<sparse_problem, RNGType, 4>(problem, rng, e, walkL, checkpointer.get());
+            if (vol < 0.0) throw Rcpp::exception("volesti failed to terminate.");
+            pair_vol = std::pair<NT, NT> (std::log(vol), vol);
             break;
         }
     }
 
+    if (trace && progress->trace().size() > 0) {
+        std::vector<volume_estimate<NT>> const& estimates = progress->trace();
+        const int k = estimates.size();
+        Rcpp::NumericVector phases(k), seconds(k), steps(k), log_volume(k), lower(k), upper(k);
+        for (int i = 0; i < k; ++i) {
+            phases[i] = estimates[i].phases_done;
+            seconds[i] = estimates[i].seconds;
+            steps[i] = estimates[i].steps;
+            log_volume[i] = estimates[i].log_volume;
+            lower[i] = estimates[i].log_lower;
+            upper[i] = estimates[i].log_upper;
+        }
+        Rcpp::DataFrame trace_df = Rcpp::DataFrame::create(Rcpp::Named("phases_done") = phases,
+                                                           Rcpp::Named("time") = seconds,
+                                                           Rcpp::Named("steps") = steps,
+                                                           Rcpp::Named("log_volume") = log_volume,
+                                                           Rcpp::Named("log_lower") = lower,
+                                                           Rcpp::Named("log_upper") = upper);
+        return Rcpp::List::create(Rcpp::Named("log_volume") = pair_vol.first, Rcpp::Named("volume") = pair_vol.second,
+                                  Rcpp::Named("converged") = progress->converged(), Rcpp::Named("trace") = trace_df);
+    }
+    if (progress && !progress->converged()) Rf_warning("The time budget was exceeded, the volume is the estimate at that time.");
+
     return Rcpp::List::create(Rcpp::Named("log_volume") = pair_vol.first, Rcpp::Named("volume") = pair_vol.second);
 }
+
+//' Volume approximation of a list of convex polytopes in parallel
+//'
+//' Approximate the volume of every polytope in a list with the algorithms of \code{volume}. The polytopes are distributed over a pool of threads; a thread that finishes a polytope takes the next one, and the largest polytopes are started first so that the threads finish close to each other.
+//'
+//' @param polytopes A list of convex polytopes. Each one is an object from class a) Hpolytope or b) Vpolytope or c) Zonotope.
+//' @param settings Optional. A list with the settings of \code{volume}, except \code{checkpoint}, \code{schedule_cache}, \code{time_budget}, \code{trace}, \code{hpoly} and \code{num_threads}, that is used for every polytope; every polytope is computed by one thread. If \code{seed} is given, the i-th polytope uses the seed \code{seed + i - 1}.
+//' @param rounding Optional. The rounding method of \code{volume} that is applied to every polytope.
+//' @param num_threads Optional. The number of threads that compute volumes concurrently. The default value is \code{1}.
+//'
+//' @return A data frame with one row per polytope and the columns: (a) \code{log_volume}, the logarithm of the estimated volume, (b) \code{volume}, the estimated volume, (c) \code{time}, the seconds spent on the polytope and (d) \code{error}, the error message if the computation failed, in which case the volume is \code{NA}, or \code{NA} otherwise.
+//' @examples
+//' # the volumes of the unit cubes of dimension 2 to 6, computed by 2 threads
+//' polytopes = lapply(2:6, function(d) gen_cube(d, 'H'))
+//' res = volume_batch(polytopes, num_threads = 2)
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame volume_batch(Rcpp::List polytopes,
+                             Rcpp::Nullable<Rcpp::List> settings = R_NilValue,
+                             Rcpp::Nullable<std::string> rounding = R_NilValue,
+                             unsigned int num_threads = 1) {
+
+    typedef double NT;
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT> RNGType;
+    typedef HPolytope <Point> Hpolytope;
+    typedef VPolytope <Point> Vpolytope;
+    typedef Zonotope <Point> zonotope;
+    typedef Eigen::Matrix<NT,Eigen::Dynamic,1> VT;
+    typedef Eigen::Matrix<NT,Eigen::Dynamic,Eigen::Dynamic> MT;
+
+    if (num_threads < 1) throw Rcpp::exception("The number of threads has to be a positive integer!");
+    if (Rcpp::as<Rcpp::List>(settings).containsElementNamed("num_threads")) {
+        Rf_warning("input 'num_threads' of the settings is not used by volume_batch, every polytope is computed by one thread.");
+    }
+    if (Rcpp::as<Rcpp::List>(settings).containsElementNamed("checkpoint") ||
+        Rcpp::as<Rcpp::List>(settings).containsElementNamed("schedule_cache") ||
+        Rcpp::as<Rcpp::List>(settings).containsElementNamed("schedule_cache_dir") ||
+        Rcpp::as<Rcpp::List>(settings).containsElementNamed("time_budget") ||
+        Rcpp::as<Rcpp::List>(settings).containsElementNamed("trace")) {
+        Rf_warning("inputs 'checkpoint', 'schedule_cache', 'time_budget' and 'trace' can not be used by volume_batch.");
+    }
+
+    const int k = polytopes.size();
+    std::vector<unsigned int> type(k), dims(k), index(k), seeds(k);
+    std::vector<volume_settings> parsed(k);
+    std::vector<NT> cost(k);
+    std::vector<Hpolytope> HPs;
+    std::vector<Vpolytope> VPs;
+    std::vector<zonotope> ZPs;
+
+    // the R objects are read and the settings are checked for every polytope before
+    // the threads start, as R is not thread safe; the workers throw only std::exception
+    for (int i = 0; i < k; ++i) {
+        Rcpp::Reference P = Rcpp::as<Rcpp::Reference>(polytopes[i]);
+        std::string type_str = Rcpp::as<std::string>(P.slot("type"));
+        unsigned int n;
+        if (type_str.compare(std::string("Hpolytope")) == 0) {
+            MT A = Rcpp::as<MT>(P.slot("A"));
+            n = A.cols();
+            type[i] = 1;
+            index[i] = HPs.size();
+            HPs.push_back(Hpolytope(n, A, Rcpp::as<VT>(P.slot("b"))));
+            cost[i] = NT(A.rows()) * NT(n);
+        } else if (type_str.compare(std::string("Vpolytope")) == 0) {
+            MT V = Rcpp::as<MT>(P.slot("V"));
+            n = V.cols();
+            type[i] = 2;
+            index[i] = VPs.size();
+            VPs.push_back(Vpolytope(n, V, VT::Ones(V.rows())));
+            set_cached_inner_ball(P, VPs.back());
+            cost[i] = NT(V.rows()) * NT(n);
+        } else if (type_str.compare(std::string("Zonotope")) == 0) {
+            MT G = Rcpp::as<MT>(P.slot("G"));
+            n = G.cols();
+            type[i] = 3;
+            index[i] = ZPs.size();
+            ZPs.push_back(zonotope(n, G, VT::Ones(G.rows())));
+            set_cached_inner_ball(P, ZPs.back());
+            cost[i] = NT(G.rows()) * NT(n);
+        } else {
+            throw Rcpp::exception("volume_batch supports H-polytopes, V-polytopes and zonotopes!");
+        }
+        dims[i] = n;
+        parsed[i] = parse_volume_settings(settings, rounding, n, type[i]);
+    }
+
+    // one seed per polytope, so the results do not depend on the number of threads
+    RNGType master(1);
+    bool set_seed = Rcpp::as<Rcpp::List>(settings).containsElementNamed("seed");
+    unsigned seed_tmp = set_seed ? Rcpp::as<double>(Rcpp::as<Rcpp::List>(settings)["seed"]) : 0;
+    for (int i = 0; i < k; ++i) {
+        seeds[i] = set_seed ? seed_tmp + i : (unsigned int)(master.sample_urdist()
+                                                            * NT(std::numeric_limits<unsigned int>::max()));
+    }
+
+    std::vector<int> order(k);
+    for (int i = 0; i < k; ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&cost](int a, int b) { return cost[a] > cost[b]; });
+
+    std::vector<NT> log_vol(k), vol(k), time(k);
+    std::vector<std::string> errors(k);
+    std::vector<char> failed(k, 0);
+
+    // the polytopes are the unit of parallelism, so every one of them is computed by
+    // a single thread and the threads are not oversubscribed
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
+    for (int j = 0; j < k; ++j) {
+        const int i = order[j];
+        volume_settings const& s = parsed[i];
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        try {
+            RNGType rng(dims[i]);
+            rng.set_seed(seeds[i]);
+            std::pair<NT, NT> pair_vol;
+            switch (type[i]) {
+                case 1:
+                    pair_vol = generic_volume(HPs[index[i]], rng, s.walk_length, s.error, s.algo, s.win_len,
+                                              s.rounding, s.walk);
+                    break;
+                case 2:
+                    pair_vol = generic_volume(VPs[index[i]], rng, s.walk_length, s.error, s.algo, s.win_len,
+                                              s.rounding, s.walk);
+                    break;
+                default:
+                    pair_vol = generic_volume(ZPs[index[i]], rng, s.walk_length, s.error, s.algo, s.win_len,
+                                              s.rounding, s.walk);
+                    break;
+            }
+            log_vol[i] = pair_vol.first;
+            vol[i] = pair_vol.second;
+        } catch (std::exception const& ex) {
+            failed[i] = 1;
+            errors[i] = ex.what();
+        }
+        time[i] = std::chrono::duration<NT>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    Rcpp::NumericVector log_volume(k), volume(k), seconds(k);
+    Rcpp::CharacterVector error(k);
+    for (int i = 0; i < k; ++i) {
+        log_volume[i] = failed[i] ? NA_REAL : log_vol[i];
+        volume[i] = failed[i] ? NA_REAL : vol[i];
+        seconds[i] = time[i];
+        error[i] = failed[i] ? Rcpp::String(errors[i]) : Rcpp::String(NA_STRING);
+    }
+
+    return Rcpp::DataFrame::create(Rcpp::Named("log_volume") = log_volume, Rcpp::Named("volume") = volume,
+                                   Rcpp::Named("time") = seconds, Rcpp::Named("error") = error,
+                                   Rcpp::Named("stringsAsFactors") = false);
+}
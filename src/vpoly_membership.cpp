@@ -0,0 +1,56 @@
+// [[Rcpp::depends(BH)]]
+
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2024 Vissarion Fisikopoulos
+// Copyright (c) 2018-2024 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+
+#include <Rcpp.h>
+#include <RcppEigen.h>
+#include "cartesian_geom/cartesian_kernel.h"
+#include "convex_bodies/vpolytope.h"
+
+//' An internal Rccp function for the membership oracle of a V-polytope
+//'
+//' @param P A V-polytope.
+//' @param points A \eqn{d\times N} matrix that contains column-wise the points to test.
+//' @param cache_size Optional. The number of simplices that the membership cache keeps, 0 solves a linear program for every point. The default value is 64.
+//'
+//' @keywords internal
+//'
+//' @return A list with a logical vector \code{inside}, whether each point is in P, and the number \code{cache_hits} of the points answered without a linear program
+// [[Rcpp::export]]
+Rcpp::List vpoly_membership(Rcpp::Reference P, Rcpp::NumericMatrix points,
+                            unsigned int cache_size = 64) {
+
+    typedef double NT;
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef VPolytope<Point> Vpolytope;
+    typedef Eigen::Matrix<NT,Eigen::Dynamic,1> VT;
+    typedef Eigen::Matrix<NT,Eigen::Dynamic,Eigen::Dynamic> MT;
+
+    if (Rcpp::as<std::string>(P.slot("type")).compare(std::string("Vpolytope")) != 0) {
+        throw Rcpp::exception("The polytope has to be a V-polytope.");
+    }
+    MT V = Rcpp::as<MT>(P.slot("V"));
+    unsigned int n = V.cols();
+    MT X = Rcpp::as<MT>(points);
+    if (X.rows() != n) {
+        throw Rcpp::exception("The points have to be in the dimension of the polytope.");
+    }
+
+    Vpolytope VP(n, V, VT::Ones(V.rows()));
+    VP.set_membership_cache_size(cache_size);
+
+    Rcpp::LogicalVector inside(X.cols());
+    for (int i = 0; i < X.cols(); ++i) {
+        inside[i] = VP.is_in(Point(VT(X.col(i)))) == -1;
+    }
+
+    return Rcpp::List::create(Rcpp::Named("inside") = inside,
+                              Rcpp::Named("cache_hits") = double(VP.membership_cache_hits()));
+}
@@ -17,12 +17,13 @@
 #include "volume/volume_cooling_gaussians.hpp"
 #include "volume/volume_cooling_balls.hpp"
 #include "volume/volume_cooling_hpoly.hpp"
+#include "cachedInnerBall.h"
 
 //' An internal Rccp function for the over-approximation of a zonotope
 //'
 //' @param Z A zonotope.
 //' @param fit_ratio Optional. A boolean parameter to request the computation of the ratio of fitness.
-//' @param settings Optional. A list that declares the values of the parameters of CB algorithm.
+//' @param settings Optional. A list that declares the values of the parameters of CB algorithm and the number of threads.
 //' @param seed Optional. A fixed seed for the number generator.
 //'
 //' @keywords internal
@@ -43,7 +44,7 @@ Rcpp::List zono_approx (Rcpp::Reference Z,
     typedef Eigen::Matrix<NT, Eigen::Dynamic, 1> VT;
     typedef Eigen::Matrix <NT, Eigen::Dynamic, Eigen::Dynamic> MT;
 
-    int k = Rcpp::as<MT>(Z.slot("G")).rows(), win_len = 250, walkL = 1;
+    int k = Rcpp::as<MT>(Z.slot("G")).rows(), win_len = 250, walkL = 1, num_threads = 1;
 
     std::string type = Rcpp::as<std::string>(Z.slot("type"));
 
@@ -88,8 +89,12 @@ Rcpp::List zono_approx (Rcpp::Reference Z,
                 Rcpp::as<Rcpp::List>(settings)["error"]);
         win_len = (!Rcpp::as<Rcpp::List>(settings).containsElementNamed("win_len")) ? 200 : Rcpp::as<int>(
                 Rcpp::as<Rcpp::List>(settings)["win_len"]);
+        num_threads = (!Rcpp::as<Rcpp::List>(settings).containsElementNamed("num_threads")) ? 1 : Rcpp::as<int>(
+                Rcpp::as<Rcpp::List>(settings)["num_threads"]);
+        if (num_threads < 1) throw Rcpp::exception("The number of threads has to be a positive integer!");
 
         zonotope ZP(n, Rcpp::as<MT>(Z.slot("G")), VT::Ones(Rcpp::as<MT>(Z.slot("G")).rows()));
+        set_cached_inner_ball(Z, ZP);
 
         if (Rcpp::as<Rcpp::List>(settings).containsElementNamed("hpoly")) {
             hpoly = Rcpp::as<bool>(Rcpp::as<Rcpp::List>(settings)["hpoly"]);
@@ -101,9 +106,9 @@ Rcpp::List zono_approx (Rcpp::Reference Z,
 
         NT vol;
         if (!hpoly) {
-            vol = volume_cooling_balls<BilliardWalk>(ZP, rng, e, walkL, win_len).second;
+            vol = volume_cooling_balls<BilliardWalk>(ZP, rng, e, walkL, win_len, num_threads).second;
         } else {
-            vol = volume_cooling_hpoly<BilliardWalk, Hpolytope>(ZP, rng, e, walkL, win_len);
+            vol = volume_cooling_hpoly<BilliardWalk, Hpolytope>(ZP, rng, e, walkL, win_len, num_threads);
         }
         ratio = std::pow(vol_red / vol, 1.0 / NT(n));
     }